@@ -0,0 +1,35 @@
+//
+//  DeadEnds
+//
+//  arena.h -- Header file for the Arena type.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#ifndef arena_h
+#define arena_h
+
+#include "standard.h"
+
+typedef struct ArenaBlock ArenaBlock;
+
+//  Arena -- A bump allocator. Memory is taken from large blocks and is never freed piece by piece;
+//    all of it is freed at once when the arena is deleted. An arena must only be used by one
+//    thread at a time.
+//--------------------------------------------------------------------------------------------------
+typedef struct Arena {
+	ArenaBlock *blocks;  // Blocks allocated so far; the current block is first.
+	char *next;          // Next free byte in the current block.
+	char *end;           // End of the current block.
+	size_t blockSize;    // Size of normal blocks.
+	size_t bytesUsed;    // Bytes handed out so far.
+} Arena;
+
+Arena *createArena(size_t blockSize);  // Create an arena; 0 uses the default block size.
+void deleteArena(Arena*);  // Free an arena and everything allocated from it.
+Word arenaAlloc(Arena*, size_t);  // Allocate aligned memory from an arena.
+String arenaStrsave(Arena*, String);  // Save a copy of a string in an arena.
+void mergeArena(Arena *into, Arena *from);  // Move the blocks of one arena to another.
+
+#endif // arena_h
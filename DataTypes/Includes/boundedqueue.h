@@ -0,0 +1,38 @@
+//
+//  DeadEnds
+//
+//  boundedqueue.h -- Header file for the BoundedQueue type.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#ifndef boundedqueue_h
+#define boundedqueue_h
+
+#include <pthread.h>
+#include "standard.h"
+
+//  BoundedQueue -- A first in first out queue of a fixed number of elements that passes work
+//    between threads. Adding to a full queue waits for room and taking from an empty queue waits
+//    for an element. Closing a queue ends the waits; elements already in it can still be taken.
+//    Elements must not be null.
+//--------------------------------------------------------------------------------------------------
+typedef struct BoundedQueue {
+	Word *elements;         // Circular array of elements.
+	int capacity;           // Number of elements the queue can hold.
+	int head;               // Index of the first element.
+	int count;              // Number of elements in the queue.
+	bool closed;            // Whether the queue has been closed.
+	pthread_mutex_t mutex;  // Guards the fields above.
+	pthread_cond_t notEmpty;  // Signaled when an element is added or the queue is closed.
+	pthread_cond_t notFull;   // Signaled when an element is taken or the queue is closed.
+} BoundedQueue;
+
+BoundedQueue *createBoundedQueue(int capacity);  // Create an empty queue.
+void deleteBoundedQueue(BoundedQueue*);  // Delete a queue; its elements are not freed.
+bool putBoundedQueue(BoundedQueue*, Word);  // Add an element; returns false if the queue is closed.
+Word takeBoundedQueue(BoundedQueue*);  // Take an element; returns null when closed and empty.
+void closeBoundedQueue(BoundedQueue*);  // Close a queue.
+
+#endif // boundedqueue_h
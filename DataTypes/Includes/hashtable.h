@@ -1,44 +1,34 @@
 //
 //  DeadEnds
 //
-//  hashtable.h -- Implements a HashTable. A HashTable is an array of MAX_HASH buckets. A bucket
-//    is a list of elements with the same hash value. Elements are defined by the user. The user
-//    must provide a compare function used to keep the elements in the buckets sorted.
+//  hashtable.h -- Implements a HashTable. A HashTable is an open addressing table of elements
+//    that grows as elements are added. Elements are defined by the user, who provides a function
+//    that gets the String key of an element. The full hash of each element's key is kept next to
+//    it, so most probes that do not match are rejected without comparing keys.
 //
 //  Created by Thomas Wetmore 29 November 2022.
-//  Last changed on 20 October 2023.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef hashtable_h
 #define hashtable_h
 
+#include <stdint.h>
 #include "standard.h"
 
-#define MAX_HASH 1024
-//#define MAX_HASH 16  // DBUG: Make MAXHASH small for debugging.
-#define INITIAL_BUCKET_LENGTH 30
-//#define INITIAL_BUCKET_LENGTH 4  // DBUG: Make the initial bucket length small for debugging.
-#define SORT_THRESHOLD 30
-//#define SORT_THRESHOLD 4  //  DBUG: Make the sort threshold small to debug the quick sort.
+#define INITIAL_HASH_CAPACITY 16  // Number of slots allocated at the first insert.
 
-//  Bucket -- Hash tables consist of MAXHASH buckets. Each bucket holds an array of elements.
-//    The elements are treated as void* pointers. When a bucket's size reaches the sort
-//    threshold, the elements are sorted using the hash table's compare function.
-//--------------------------------------------------------------------------------------------------
-typedef struct Bucket {
-	int length;      //  Current size of this bucket.
-	int maxLength;   //  Maximum size this bucket can be before reallocation.
-	bool sorted;     //  True when this bucket is sorted.
-	Word *elements;  //  The elements in this bucket.
-} Bucket;
-
-//  HashTable -- Hash table.
+//  HashTable -- Hash table. The elements are kept with Robin Hood linear probing: an element is
+//    never further from the slot its hash picks than an element it passed on the way, so a search
+//    stops as soon as it meets an element closer to its own slot than the search is.
 //--------------------------------------------------------------------------------------------------
 typedef struct HashTable {
-	int (*compare)(Word, Word);  //  Compare two elements in a bucket.
+	int (*compare)(Word, Word);  //  Compare two elements; kept for users, the table doesn't sort.
 	void (*delete)(Word);        //  Function to delete an element.
 	String(*getKey)(Word);       //  Function to get the key from an element.
-	Bucket *buckets[MAX_HASH];   //  Buckets of the hash table.
+	Word *elements;              //  Slots of the table; null slots are empty.
+	uint32_t *hashes;            //  Hash of the key of the element in each slot.
+	int capacity;                //  Number of slots; a power of two, or 0 before the first insert.
 	int count;                   //  The number of elements in the table.
 } HashTable;
 
@@ -50,20 +40,14 @@ bool isInHashTable(HashTable*, String key);  //  Return whether an element with
 Word searchHashTable(HashTable*, String key);  // Return the element that matches the key.
 
 void insertInHashTable(HashTable*, Word element);  // Add a new element to the table.
+void reserveHashTable(HashTable*, int count);  // Make room for count elements.
 Word firstInHashTable(HashTable*, int*, int*);  // Return first element in a new iteration.
 Word nextInHashTable(HashTable*, int*, int*);  // Return next table element in iteration.
 int sizeHashTable(HashTable*);  // Return the number of elements in a table.
 void showHashTable(HashTable*, void (*show)(Word));  // Show the contents of a table; for debugging.
-/*static*/ int getHash(String);  // Return the hashed value of a String.
+uint32_t getHash(String);  // Return the hashed value of a String.
 void removeFromHashTable(HashTable*, String key);
 int iterateHashTableWithPredicate(HashTable*, bool (*function)(Word element));
-
-//  SHOULDN'T THE BUCKET FUNCTIONS BE STATIC, SO NOT DECLARED IN HERE AT ALL??
-Bucket *createBucket(void);  // Create a bucket.
-void deleteBucket(Bucket*, void(*)(Word));  // Delete a bucket.
-Word searchBucket(Bucket*, String key, int(*compare)(Word, Word), String (*getKey)(Word), int* index);  // Search a bucket.
-
-void appendToBucket(Bucket*, Word element);  // Append an element to a bucket.
 void removeElement(HashTable*, Word element);  // Remove an element from the hash table.
 
 //  The rest of this file defines the interfaces to hash tables with specific element types.
@@ -78,19 +62,20 @@ typedef struct WordElement {
 	Word value;
 } WordElement;
 
-//  Macros for iterating over all elements in a hash table. Meanings of the brackets: outside
+//  Macros for iterating over all elements in a hash table. The elements are visited in slot
+//    order. The table must not be changed during the loop. Meanings of the brackets: outside
 //    pair of brackets enclose the full macro expansion; the middle pair of brackets enclose the
-//    internal while loop; and the inner pair of brackets enclose what the user provides as the
-//    loop body.
+//    internal for loop; and the inner pair of brackets enclose what the user provides as the
+//    loop body, so continue goes on to the next element.
 //-------------------------------------------------------------------------------------------------
 #define FORHASHTABLE(table, element) {\
 			int __i = 0, __j = 0;\
 			HashTable *__table = table;\
-			Word element = firstInHashTable(__table, &__i, &__j);\
-			while (element) {{\
-			
-#define ENDHASHTABLE }\
-			element = nextInHashTable(__table, &__i, &__j);\
-		}}\
+			for (Word __element = firstInHashTable(__table, &__i, &__j); __element;\
+				 __element = nextInHashTable(__table, &__i, &__j)) {\
+				Word element = __element;\
+				{
+
+#define ENDHASHTABLE }}}
 
 #endif // hashtable_h
@@ -0,0 +1,37 @@
+//
+//  DeadEnds
+//
+//  internpool.h -- Header file for the InternPool type.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#ifndef internpool_h
+#define internpool_h
+
+#include <stdint.h>
+#include "standard.h"
+#include "arena.h"
+
+//  InternPool -- A set of immutable strings with one copy of each. Interning a string returns the
+//    pool's copy, so equal strings share memory. The copies live in an arena and are freed when the
+//    pool is deleted. A pool must only be used by one thread at a time.
+//--------------------------------------------------------------------------------------------------
+typedef struct InternPool {
+	Arena *arena;         // Arena holding the strings.
+	String *slots;        // Open addressing table of strings; null slots are empty.
+	uint32_t *hashes;     // Hash of the string in each slot.
+	uint32_t size;        // Number of slots; a power of two.
+	uint32_t count;       // Number of distinct strings in the pool.
+	uint64_t lookups;     // Number of strings interned.
+	uint64_t hits;        // Number of strings found already in the pool.
+	uint64_t bytesSaved;  // Bytes not allocated because of hits.
+} InternPool;
+
+InternPool *createInternPool(void);  // Create an empty intern pool.
+void deleteInternPool(InternPool*);  // Delete a pool and all its strings.
+String internString(InternPool*, String);  // Return the pool's copy of a string.
+void showInternPoolStats(InternPool*);  // Show how much sharing the pool has done.
+
+#endif // internpool_h
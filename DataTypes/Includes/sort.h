@@ -6,7 +6,7 @@
 //    binary search.
 //
 //  Created by Thomas Wetmore on 21 November 2022.
-//  Last changed on 10 April 2023.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef sort_h
@@ -16,9 +16,10 @@
 #include "list.h"  // List.
 
 // ldata and lcmp -- State variables used to simplify the interfaces to the sorting functions.
+//    Each thread has its own so threads can sort at the same time.
 //--------------------------------------------------------------------------------------------------
-extern Word *ldata;              // The data to be sorted.
-extern int (*lcmp)(Word, Word);  // The compare function.
+extern _Thread_local Word *ldata;              // The data to be sorted.
+extern _Thread_local int (*lcmp)(Word, Word);  // The compare function.
 
 void quickSort (int left, int right);
 
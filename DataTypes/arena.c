@@ -0,0 +1,126 @@
+//
+//  DeadEnds
+//
+//  arena.c -- Functions that implement Arenas, bump allocators used for data that lives and dies
+//    together, such as the node trees of a database. Allocating from an arena is a pointer bump,
+//    and an arena is freed a block at a time rather than an object at a time.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#include "arena.h"
+
+#define DEFAULT_BLOCK_SIZE (1 << 20)
+#define ARENA_ALIGNMENT 8
+
+//  ArenaBlock -- A block of memory in an arena.
+//--------------------------------------------------------------------------------------------------
+struct ArenaBlock {
+	ArenaBlock *next;  // Next block in the arena.
+	char data[];       // Memory handed out by the arena.
+};
+
+//  createArena -- Create an arena.
+//--------------------------------------------------------------------------------------------------
+Arena *createArena(size_t blockSize)
+//  blockSize -- Size of the blocks the arena allocates; 0 uses the default size.
+{
+	Arena *arena = (Arena*) stdalloc(sizeof(Arena));
+	arena->blocks = null;
+	arena->next = arena->end = null;
+	arena->blockSize = blockSize ? blockSize : DEFAULT_BLOCK_SIZE;
+	arena->bytesUsed = 0;
+	return arena;
+}
+
+//  deleteArena -- Delete an arena and free all the memory allocated from it.
+//--------------------------------------------------------------------------------------------------
+void deleteArena(Arena *arena)
+{
+	ASSERT(arena);
+	ArenaBlock *block = arena->blocks;
+	while (block) {
+		ArenaBlock *next = block->next;
+		stdfree(block);
+		block = next;
+	}
+	stdfree(arena);
+}
+
+//  allocBlock -- Allocate a block for an arena and link it into the arena's block list. Blocks for
+//    large requests are linked in after the current block so the current block stays in use.
+//--------------------------------------------------------------------------------------------------
+static char *allocBlock(Arena *arena, size_t size, bool current)
+{
+	ArenaBlock *block = (ArenaBlock*) stdalloc(sizeof(ArenaBlock) + size);
+	if (current || !arena->blocks) {
+		block->next = arena->blocks;
+		arena->blocks = block;
+		if (current) {
+			arena->next = block->data;
+			arena->end = block->data + size;
+		}
+	} else {
+		block->next = arena->blocks->next;
+		arena->blocks->next = block;
+	}
+	return block->data;
+}
+
+//  arenaAllocUnaligned -- Allocate memory from an arena without aligning it.
+//--------------------------------------------------------------------------------------------------
+static char *arenaAllocUnaligned(Arena *arena, size_t size)
+{
+	arena->bytesUsed += size;
+	if (size > arena->blockSize/4) return allocBlock(arena, size, false);
+	if (arena->end - arena->next < (long) size) allocBlock(arena, arena->blockSize, true);
+	char *memory = arena->next;
+	arena->next += size;
+	return memory;
+}
+
+//  arenaAlloc -- Allocate memory from an arena. The memory is aligned for pointers.
+//--------------------------------------------------------------------------------------------------
+Word arenaAlloc(Arena *arena, size_t size)
+//  arena -- Arena to allocate from.
+//  size -- Number of bytes to allocate.
+{
+	ASSERT(arena);
+	size_t padding = (ARENA_ALIGNMENT - (size_t) arena->next % ARENA_ALIGNMENT) % ARENA_ALIGNMENT;
+	if (arena->next && arena->end - arena->next >= (long) (padding + size)) arena->next += padding;
+	else size = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+	return arenaAllocUnaligned(arena, size);
+}
+
+//  arenaStrsave -- Save a copy of a string in an arena.
+//--------------------------------------------------------------------------------------------------
+String arenaStrsave(Arena *arena, String string)
+{
+	ASSERT(arena && string);
+	size_t length = strlen(string) + 1;
+	String copy = arenaAllocUnaligned(arena, length);
+	memcpy(copy, string, length);
+	return copy;
+}
+
+//  mergeArena -- Move the blocks of one arena into another and delete the first. Used to combine
+//    arenas filled on different threads. The memory allocated from both stays where it is.
+//--------------------------------------------------------------------------------------------------
+void mergeArena(Arena *into, Arena *from)
+//  into -- Arena that takes over the blocks.
+//  from -- Arena whose blocks are taken; it is deleted.
+{
+	ASSERT(into && from);
+	ArenaBlock *last = from->blocks;
+	if (last) {
+		while (last->next) last = last->next;
+		if (into->blocks) {
+			last->next = into->blocks->next;
+			into->blocks->next = from->blocks;
+		} else
+			into->blocks = from->blocks;
+	}
+	into->bytesUsed += from->bytesUsed;
+	stdfree(from);
+}
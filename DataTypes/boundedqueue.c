@@ -0,0 +1,93 @@
+//
+//  DeadEnds
+//
+//  boundedqueue.c -- Implements the BoundedQueue type, a fixed size queue that passes work from
+//    one thread to another.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#include "boundedqueue.h"
+
+//  createBoundedQueue -- Create an empty queue that holds up to capacity elements.
+//--------------------------------------------------------------------------------------------------
+BoundedQueue *createBoundedQueue(int capacity)
+//  capacity -- Number of elements the queue can hold.
+{
+	ASSERT(capacity > 0);
+	BoundedQueue *queue = (BoundedQueue*) stdalloc(sizeof(BoundedQueue));
+	queue->elements = (Word*) stdalloc(capacity*sizeof(Word));
+	queue->capacity = capacity;
+	queue->head = queue->count = 0;
+	queue->closed = false;
+	pthread_mutex_init(&queue->mutex, null);
+	pthread_cond_init(&queue->notEmpty, null);
+	pthread_cond_init(&queue->notFull, null);
+	return queue;
+}
+
+//  deleteBoundedQueue -- Delete a queue. No thread may be using it. Its elements are not freed.
+//--------------------------------------------------------------------------------------------------
+void deleteBoundedQueue(BoundedQueue *queue)
+{
+	ASSERT(queue);
+	pthread_mutex_destroy(&queue->mutex);
+	pthread_cond_destroy(&queue->notEmpty);
+	pthread_cond_destroy(&queue->notFull);
+	stdfree(queue->elements);
+	stdfree(queue);
+}
+
+//  putBoundedQueue -- Add an element to the end of a queue, waiting until there is room. Returns
+//    false, without adding the element, if the queue is or becomes closed.
+//--------------------------------------------------------------------------------------------------
+bool putBoundedQueue(BoundedQueue *queue, Word element)
+//  queue -- Queue to add to.
+//  element -- Element to add; must not be null.
+{
+	ASSERT(queue && element);
+	pthread_mutex_lock(&queue->mutex);
+	while (queue->count == queue->capacity && !queue->closed)
+		pthread_cond_wait(&queue->notFull, &queue->mutex);
+	bool added = !queue->closed;
+	if (added) {
+		queue->elements[(queue->head + queue->count++) % queue->capacity] = element;
+		pthread_cond_signal(&queue->notEmpty);
+	}
+	pthread_mutex_unlock(&queue->mutex);
+	return added;
+}
+
+//  takeBoundedQueue -- Take the element at the front of a queue, waiting until there is one.
+//    Returns null when the queue is closed and empty.
+//--------------------------------------------------------------------------------------------------
+Word takeBoundedQueue(BoundedQueue *queue)
+{
+	ASSERT(queue);
+	pthread_mutex_lock(&queue->mutex);
+	while (queue->count == 0 && !queue->closed)
+		pthread_cond_wait(&queue->notEmpty, &queue->mutex);
+	Word element = null;
+	if (queue->count > 0) {
+		element = queue->elements[queue->head];
+		queue->head = (queue->head + 1) % queue->capacity;
+		queue->count--;
+		pthread_cond_signal(&queue->notFull);
+	}
+	pthread_mutex_unlock(&queue->mutex);
+	return element;
+}
+
+//  closeBoundedQueue -- Close a queue. Threads waiting to add or take elements stop waiting;
+//    elements already in the queue can still be taken, but no more can be added.
+//--------------------------------------------------------------------------------------------------
+void closeBoundedQueue(BoundedQueue *queue)
+{
+	ASSERT(queue);
+	pthread_mutex_lock(&queue->mutex);
+	queue->closed = true;
+	pthread_cond_broadcast(&queue->notEmpty);
+	pthread_cond_broadcast(&queue->notFull);
+	pthread_mutex_unlock(&queue->mutex);
+}
@@ -0,0 +1,112 @@
+//
+//  DeadEnds
+//
+//  internpool.c -- Functions that implement InternPools. Gedcom values such as places, dates and
+//    source references repeat many times in a file; interning them keeps one copy of each.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#include "internpool.h"
+
+#define INITIAL_SLOTS 4096
+
+//  hashString -- Hash function for interned strings.
+//--------------------------------------------------------------------------------------------------
+static uint32_t hashString(String string, size_t *length)
+{
+	uint32_t hash = 2166136261u;
+	String p = string;
+	while (*p) hash = (hash ^ (unsigned char) *p++) * 16777619u;
+	*length = p - string;
+	return hash;
+}
+
+//  createInternPool -- Create an empty intern pool.
+//--------------------------------------------------------------------------------------------------
+InternPool *createInternPool(void)
+{
+	InternPool *pool = (InternPool*) stdalloc(sizeof(InternPool));
+	pool->arena = createArena(0);
+	pool->size = INITIAL_SLOTS;
+	pool->slots = (String*) stdalloc(pool->size*sizeof(String));
+	memset(pool->slots, 0, pool->size*sizeof(String));
+	pool->hashes = (uint32_t*) stdalloc(pool->size*sizeof(uint32_t));
+	pool->count = 0;
+	pool->lookups = pool->hits = pool->bytesSaved = 0;
+	return pool;
+}
+
+//  deleteInternPool -- Delete an intern pool. Strings returned by internString must not be used
+//    afterwards.
+//--------------------------------------------------------------------------------------------------
+void deleteInternPool(InternPool *pool)
+{
+	ASSERT(pool);
+	deleteArena(pool->arena);
+	stdfree(pool->slots);
+	stdfree(pool->hashes);
+	stdfree(pool);
+}
+
+//  growPool -- Double the number of slots in an intern pool and rehash its strings.
+//--------------------------------------------------------------------------------------------------
+static void growPool(InternPool *pool)
+{
+	uint32_t size = 2*pool->size;
+	String *slots = (String*) stdalloc(size*sizeof(String));
+	memset(slots, 0, size*sizeof(String));
+	uint32_t *hashes = (uint32_t*) stdalloc(size*sizeof(uint32_t));
+	for (uint32_t i = 0; i < pool->size; i++) {
+		if (!pool->slots[i]) continue;
+		uint32_t slot = pool->hashes[i] & (size - 1);
+		while (slots[slot]) slot = (slot + 1) & (size - 1);
+		slots[slot] = pool->slots[i];
+		hashes[slot] = pool->hashes[i];
+	}
+	stdfree(pool->slots);
+	stdfree(pool->hashes);
+	pool->slots = slots;
+	pool->hashes = hashes;
+	pool->size = size;
+}
+
+//  internString -- Return the pool's copy of a string, adding a copy to the pool if the string
+//    is new. The copy must not be changed or freed.
+//--------------------------------------------------------------------------------------------------
+String internString(InternPool *pool, String string)
+//  pool -- Intern pool.
+//  string -- String to intern; it is not kept.
+{
+	ASSERT(pool && string);
+	size_t length;
+	uint32_t hash = hashString(string, &length);
+	uint32_t mask = pool->size - 1;
+	uint32_t slot = hash & mask;
+	pool->lookups++;
+	while (pool->slots[slot]) {
+		if (pool->hashes[slot] == hash && eqstr(pool->slots[slot], string)) {
+			pool->hits++;
+			pool->bytesSaved += length + 1;
+			return pool->slots[slot];
+		}
+		slot = (slot + 1) & mask;
+	}
+	String copy = (String) arenaAlloc(pool->arena, length + 1);
+	memcpy(copy, string, length + 1);
+	pool->slots[slot] = copy;
+	pool->hashes[slot] = hash;
+	if (2*++pool->count > pool->size) growPool(pool);
+	return copy;
+}
+
+//  showInternPoolStats -- Show how many strings a pool holds and how much sharing it has done.
+//--------------------------------------------------------------------------------------------------
+void showInternPoolStats(InternPool *pool)
+{
+	ASSERT(pool);
+	printf("Interned %llu strings: %u distinct, %llu shared, %llu bytes saved, %zu bytes used.\n",
+		   (unsigned long long) pool->lookups, pool->count, (unsigned long long) pool->hits,
+		   (unsigned long long) pool->bytesSaved, pool->arena->bytesUsed);
+}
@@ -7,7 +7,7 @@
 //  kept unique via the compare function.
 //
 //  Created by Thomas Wetmore on 22 November 2022.
-//  Last changed 4 November 2023.
+//  Last changed 17 October 2026.
 //
 
 #include "set.h"
@@ -44,7 +44,12 @@ void addToSet(Set *set, Word element)
 {
 	int index;
 	Word entry = searchList(set->list, element, &index);
-	if (!entry) insertListElement(set->list, index, element);
+	if (entry) return;
+	//  Inserting at the searched index keeps a sorted list sorted, so don't make the next search
+	//    sort it again.
+	bool isSorted = set->list->isSorted;
+	insertListElement(set->list, index, element);
+	set->list->isSorted = isSorted;
 }
 
 // Check if an element is in a set. Delegate to the list. Delegate to the list.
@@ -5,7 +5,7 @@
 //    that compares pairs of elements must be provided.
 //
 //  Created by Thomas Wetmore on 21 November 2022.
-//  Last changed on 4 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "standard.h"
@@ -15,10 +15,11 @@ static bool debugging = false;
 
 #define LNULL -1
 
-// ldata and lcmp -- State variables that simplify the interfaces to the sort functions.
+// ldata and lcmp -- State variables that simplify the interfaces to the sort functions. They are
+//    thread local so threads can sort at the same time.
 //--------------------------------------------------------------------------------------------------
-Word *ldata;              // The data to be sorted.
-int (*lcmp)(Word, Word);  // The compare function.
+_Thread_local Word *ldata;              // The data to be sorted.
+_Thread_local int (*lcmp)(Word, Word);  // The compare function.
 
 //  Prototypes for the quick sort functions.
 //--------------------------------------------------------------------------------------------------
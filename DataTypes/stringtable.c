@@ -5,7 +5,7 @@
 //    are strings.
 //
 //  Created by Thomas Wetmore on 23 April 2023.
-//  Last changed on 6 July 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "standard.h"
@@ -104,13 +104,8 @@ void showStringTable(HashTable *table)
 {
     ASSERT(table);
     printf("String Table at Location %p\n", table);
-    for (int i = 0; i < MAX_HASH; i++) {
-        Bucket *bucket = table->buckets[i];
-        if (!bucket || bucket->length <= 0) continue;
-        printf("Bucket %d\n", i);
-        for (int j = 0; j < bucket->length; j++) {
-            StringElement *element = bucket->elements[j];
-            printf("    %s -> %s\n", element->key, element->value ? element-> value : "null");
-        }
-    }
+    FORHASHTABLE(table, element)
+        StringElement *stringEl = (StringElement*) element;
+        printf("    %s -> %s\n", stringEl->key, stringEl->value ? stringEl->value : "null");
+    ENDHASHTABLE
 }
@@ -4,19 +4,31 @@
 //  database.h
 //
 //  Created by Thomas Wetmore on 10 November 2022.
-//  Last changed on 22 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef database_h
 #define database_h
 
+#include <stdint.h>
 #include "standard.h"
 #include "hashtable.h"
 #include "recordindex.h"
 #include "nameindex.h"
+#include "surnameindex.h"
 #include "gnode.h"
+#include "mappedfile.h"
+#include "arena.h"
+#include "nodestore.h"
+#include "internpool.h"
+#include "errors.h"
 
 typedef HashTable RecordIndex;
+typedef struct NodeStore NodeStore;
+typedef struct RecordIndexEl RecordIndexEl;
+typedef struct NameIndex NameIndex;
+typedef struct SurnameIndex SurnameIndex;
+typedef struct NameForms NameForms;
 
 //  Database -- Database structure for genealogical data encoded in Gedcom form.
 //--------------------------------------------------------------------------------------------------
@@ -29,12 +41,38 @@ typedef struct Database {
     RecordIndex *eventIndex;
     RecordIndex *otherIndex;
     NameIndex *nameIndex;
+    SurnameIndex *surnameIndex;  // Surnames of the persons, for prefix lookups.
+    MappedFile *mappedFile;  // Mapped Gedcom file the records point into, if any.
+    Arena *arena;  // Arena the records are allocated from, if any.
+    NodeStore *nodeStore;  // String pool of the records loaded from a snapshot, if any.
+    InternPool *valuePool;  // Pool the record values are interned in, if any.
+    ErrorLog *lazyErrorLog;  // Errors found reading records on demand; null if not lazy.
+    bool foldedValues;  // Whether CONC and CONT lines are joined into the values they continue.
+    RecordIndexEl **records;  // Record index elements of all the records, by record id.
+    int numRecords;  // Number of records with ids.
+    int maxRecords;  // Number of elements allocated for records.
 } Database;
 
+//  RecordCounts -- Number of records of each type in a Gedcom file, used to size the indexes of
+//    a database before the records are stored.
+//--------------------------------------------------------------------------------------------------
+typedef struct RecordCounts {
+    int persons;
+    int families;
+    int sources;
+    int events;
+    int others;
+} RecordCounts;
+
+extern int minPersonsPerThread;  //  Fewest persons indexNamesInParallel gives a thread.
+
 Database *createDatabase(String fileName);  //  Create an empty database.
+void reserveDatabase(Database*, RecordCounts*);  //  Size the record indexes for record counts.
 void deleteDatabase(Database*);  //  Delete a database.
 
-void indexNames(Database*);      //  Index person names after reading the Gedcom file.
+int indexNames(Database*);       //  Index person names after reading the Gedcom file.
+int indexNamesInParallel(Database*, int numThreads);  //  Index person names using threads.
+int resolveLinks(Database*, ErrorLog*);  //  Point the lineage links at the records they refer to.
 int numberPersons(Database*);    //  Return the number of persons in the database.
 int numberFamilies(Database*);   //  Return the number of families in the database.
 int numberSources(Database*);    //  Return the number of sources in the database.
@@ -45,7 +83,15 @@ GNode *keyToFamily(String key, Database*);  //  Get a family record from the dat
 GNode *keyToSource(String key, Database*);  //  Get a source record from the database.
 GNode *keyToEvent(String key, Database*);   //  Get an event record from the database.
 GNode *keyToOther(String Key, Database*);   //  Get an other record from the database.
+GNode *elementToRecord(RecordIndexEl*, Database*);  //  Get the record of a record index element.
 bool storeRecord(Database*, GNode*, int lineno);        //  Add a record to the database.
+void assignRecordId(Database*, RecordIndexEl*);  //  Give a new record the next record id.
+RecordId keyToRecordId(String key, Database*);  //  Return the id of a record; NORECORDID if none.
+String recordIdToKey(RecordId, Database*);  //  Return the key of the record with an id.
+GNode *recordIdToRecord(RecordId, Database*);  //  Return the root of the record with an id.
+NameForms *personToNameForms(GNode*, Database*);  //  Return the forms of a person's name.
+NameForms *recordIdToNameForms(RecordId, Database*);  //  Return the forms of a person's name.
+void invalidateNameForms(String key, Database*);  //  Forget the name forms of an edited person.
 void showTableSizes(Database*);          //  Show the sizes of the database tables. Debugging.
 void showPersonIndex(Database*);      //  Show the person index. Debugging.
 void showFamilyIndex(Database*);      //  Show the family index. Debugging.
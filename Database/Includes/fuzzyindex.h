@@ -0,0 +1,52 @@
+//
+//  DeadEnds
+//
+//  fuzzyindex.h -- Header file for the FuzzyIndex type, a trigram index of the full names of the
+//    persons in a database. It finds the persons whose names are within an edit distance of a
+//    name, and ranks them, for jobs that match names that may be misspelled.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#ifndef fuzzyindex_h
+#define fuzzyindex_h
+
+#include "standard.h"
+#include "database.h"
+
+#define NUMTRIGRAMS (27*27*27)  // Trigrams of the letters A to Z and space.
+#define MAXFUZZYNAMELEN 256     // Longest normalized name; longer names are cut.
+
+//  FuzzyIndex -- The normalized names of the persons of a database and, for each trigram, the
+//    names that have it. A normalized name is in upper case with its slashes and other non
+//    letters replaced by single spaces. The postings of trigram t are the name numbers from
+//    postings[offsets[t]] up to postings[offsets[t + 1]].
+//--------------------------------------------------------------------------------------------------
+typedef struct FuzzyIndex {
+	Database *database;  // Database the index was built from.
+	int numNames;        // Number of names.
+	RecordId *persons;   // Record id of the person of each name.
+	int *nameOffsets;    // Offset of each normalized name in text.
+	short *numTrigrams;  // Number of distinct trigrams of each name.
+	String text;         // The normalized names, each ending with a 0.
+	int *offsets;        // NUMTRIGRAMS + 1 offsets into postings.
+	int *postings;       // Name numbers, in order, for each trigram.
+	int *counts;         // Scratch counts of shared trigrams, one per name; all zero between searches.
+	int *touched;        // Scratch list of the names with nonzero counts.
+} FuzzyIndex;
+
+//  FuzzyMatch -- A person found by a fuzzy search.
+//--------------------------------------------------------------------------------------------------
+typedef struct FuzzyMatch {
+	RecordId id;        // Record id of the person.
+	int distance;       // Edit distance between the normalized names.
+	double similarity;  // Shared trigrams over all trigrams of the two names, 0 to 1.
+} FuzzyMatch;
+
+FuzzyIndex *createFuzzyIndex(Database*);  // Build the fuzzy name index of a database.
+void deleteFuzzyIndex(FuzzyIndex*);  // Delete a fuzzy name index.
+int searchFuzzyIndex(FuzzyIndex*, String name, int maxDistance, int topK, FuzzyMatch*);  // Search.
+int normalizeName(String name, String buffer);  // Normalize a name for fuzzy matching.
+
+#endif // fuzzyindex_h
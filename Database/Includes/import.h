@@ -4,7 +4,7 @@
 //  import.h -- Header file for the Gedcom import process.
 //
 //  Created by Thomas Wetmore on 13 November 2022.
-//  Last changed on 11 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef import_h
@@ -15,7 +15,40 @@
 #include "errors.h"
 #include "database.h"
 #include "list.h"
+#include "importstats.h"
+
+//  ImportOptions -- Options that control how a Gedcom file is imported. Passing null for the
+//    options gives the defaults, which are all false. Gzipped files are always imported with the
+//    pipeline, which decompresses them on its read ahead thread; mapping, threads and laziness
+//    are ignored for them. A prescan is not done for them or for lazy imports.
+//--------------------------------------------------------------------------------------------------
+typedef struct ImportOptions {
+	bool useMapping;  // Map the file and build nodes that point into the mapping.
+	int numThreads;   // Threads that read records and index names; more than one implies mapping.
+	bool useArena;    // Allocate the nodes and their strings from an arena owned by the database.
+	bool internValues;  // Share one copy of each distinct value; ignored when mapping.
+	bool lazy;          // Map the file and read each record when it is first needed.
+	bool pipelined;     // Read the file, build records and store them on three threads at once.
+	bool foldContinuations;  // Join CONC and CONT lines into the values of the lines they continue.
+	bool skipBadRecords;  // Log the first error in each bad record, skip it, and keep reading.
+	bool prescan;       // Count the records first and size the record indexes for them.
+	bool resolveLinks;  // Point the FAMC, FAMS, HUSB, WIFE and CHIL nodes at their records.
+	bool buildNameIndex;  // Index the names of the persons after reading the records.
+	bool validate;      // Validate the database after reading the records.
+	ImportStats *stats; // Filled with the sizes and phase times of the import, if not null.
+} ImportOptions;
+
+//  RecordVisitor -- Function called by streamFromFile on each record. The tree is freed when the
+//    function returns; it must be copied to be kept. Return false to stop the stream.
+//--------------------------------------------------------------------------------------------------
+typedef bool (*RecordVisitor)(GNode *root, int lineNumber, Word context);
 
 List *importFromFiles(String fileNames[], int count, ErrorLog*);
+List *importFromFilesConcurrently(String fileNames[], int count, ImportOptions*, ErrorLog*);
+Database *importFromFile(String fileName, ErrorLog*);
+Database *importFromFileWithOptions(String fileName, ImportOptions*, ErrorLog*);
+int streamFromFile(String fileName, RecordVisitor, Word context, ErrorLog*);
+GNode *readUnreadRecord(RecordIndexEl*, Database*);  // Read a record of a lazy database.
+void countRecords(String start, String end, RecordCounts*);  // Count the records in Gedcom text.
 
 #endif // import_h
@@ -0,0 +1,42 @@
+//
+//  DeadEnds
+//
+//  importstats.h -- Header file for ImportStats, the measurements made while importing a Gedcom
+//    file.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#ifndef importstats_h
+#define importstats_h
+
+#include <stdio.h>
+#include "standard.h"
+
+//  ImportStats -- Sizes and phase times of an import. Times are in seconds. When records are
+//    read by more than one thread the parse and normalize times are summed over the threads.
+//--------------------------------------------------------------------------------------------------
+typedef struct ImportStats {
+	size_t bytesRead;      // Bytes of the Gedcom file read.
+	int linesParsed;       // Lines read.
+	int recordsBuilt;      // Records built into node trees.
+	int linksResolved;     // Lineage links pointed at their records.
+	int namesIndexed;      // Names added to the name index.
+	int numErrors;         // Errors added to the error log.
+	int numThreads;        // Threads that read records.
+	double prescanTime;    // Counting the records to size the record indexes, if asked for.
+	double readTime;       // Reading the file, when a read ahead thread does it.
+	double parseTime;      // Reading lines and building node trees.
+	double normalizeTime;  // Normalizing records.
+	double storeTime;      // Storing records in the record indexes.
+	double resolveLinksTime;  // Resolving lineage links.
+	double indexNamesTime; // Indexing names.
+	double validateTime;   // Validating the database.
+	double totalTime;      // The whole import.
+} ImportStats;
+
+void showImportStats(ImportStats*, FILE*);  // Write import stats as text.
+void writeImportStatsJSON(ImportStats*, FILE*);  // Write import stats as a JSON object.
+
+#endif // importstats_h
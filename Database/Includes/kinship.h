@@ -0,0 +1,66 @@
+//
+//  DeadEnds
+//
+//  kinship.h -- Header file for the KinshipGraph type, a compact form of the family relationships
+//    in a database for programs that walk them many times.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#ifndef kinship_h
+#define kinship_h
+
+#include "standard.h"
+#include "hashtable.h"
+#include "database.h"
+
+//  KinshipEdges -- Edges in compressed sparse row form. The targets of the edges from node i are
+//    targets[offsets[i]] up to targets[offsets[i + 1]].
+//--------------------------------------------------------------------------------------------------
+typedef struct KinshipEdges {
+	int *offsets;  // numNodes + 1 offsets into targets.
+	int *targets;  // Dense ids of the edge targets.
+} KinshipEdges;
+
+//  KinshipGraph -- The persons and families of a database with dense ids, 0 up to numPersons or
+//    numFamilies, given in file order, and the edges between them. The graph is built from the
+//    HUSB, WIFE and CHIL links of the families, and does not change when the database does.
+//--------------------------------------------------------------------------------------------------
+typedef struct KinshipGraph {
+	Database *database;       // Database the graph was built from.
+	int numPersons;           // Number of persons.
+	int numFamilies;          // Number of families.
+	RecordIndexEl **persons;  // Record index elements of the persons, by dense id.
+	RecordIndexEl **families; // Record index elements of the families, by dense id.
+	HashTable *personIds;     // Dense ids of the persons by key.
+	HashTable *familyIds;     // Dense ids of the families by key.
+	KinshipEdges parents;     // Person to person: the persons' fathers and mothers.
+	KinshipEdges children;    // Person to person: the persons' children.
+	KinshipEdges spouses;     // Person to person: the persons' spouses.
+	KinshipEdges childIn;     // Person to family: the families the persons are children in.
+	KinshipEdges spouseIn;    // Person to family: the families the persons are spouses in.
+	KinshipEdges members;     // Family to person: the spouses then the children of the families.
+	int *numSpouses;          // Number of spouses at the start of each family's members.
+} KinshipGraph;
+
+KinshipGraph *createKinshipGraph(Database*);  // Build the kinship graph of a database.
+void deleteKinshipGraph(KinshipGraph*);  // Delete a kinship graph.
+int kinshipPersonId(KinshipGraph*, String key);  // Return the id of a person; -1 if none.
+int kinshipFamilyId(KinshipGraph*, String key);  // Return the id of a family; -1 if none.
+GNode *kinshipPerson(KinshipGraph*, int id);  // Return the root of the person with an id.
+GNode *kinshipFamily(KinshipGraph*, int id);  // Return the root of the family with an id.
+int *kinshipEdges(KinshipEdges*, int id, int *count);  // Return the targets of the edges from id.
+
+//  FORKINSHIP -- Iterate the targets of the edges from a node of a kinship graph.
+//--------------------------------------------------------------------------------------------------
+#define FORKINSHIP(edges, id, target) {\
+	int __count;\
+	int *__targets = kinshipEdges(edges, id, &__count);\
+	for (int __i = 0; __i < __count; __i++) {\
+		int target = __targets[__i];\
+		{
+
+#define ENDKINSHIP }}}
+
+#endif // kinship_h
@@ -2,35 +2,46 @@
 //  DeadEnds
 //
 //  nameindex.h -- Implements the name index type used by the DeadEnds database to index all
-//    the gedcom names in person records. A name index is a specialization of hash table.
+//    the gedcom names in person records. A name index maps name keys to sorted arrays of the
+//    record ids of the persons with names that have those keys.
 //
 //  Created by Thomas Wetmore on 26 November 2022.
-//  Last changed on 14 July 2023.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef nameindex_h
 #define nameindex_h
 
-#include "set.h"
+#include <stdint.h>
 #include "hashtable.h"
+#include "recordindex.h"
 
-//  NameElement -- An element in a name index bucket.
+//  NameElement -- An element of a name index, a name key and the location of its record ids.
 //--------------------------------------------------------------------------------------------------
 typedef struct {
-    String nameKey;   // The key of a name.
-    Set *recordKeys;  // A Set of record keys, sorted by recordKeys.
+    char nameKey[6];  // The key of a name.
+    IdGroup group;    // Record ids of the persons with names with the key.
 } NameElement;
 
-//  NameIndex -- Synonym for a hash table being used as a name table.
+//  NameIndex -- The name elements in a hash table, and the record ids of all elements in one
+//    posting list. Postings are collected and then sorted into the list together, so building
+//    the index does no work per name beyond finding its element.
 //--------------------------------------------------------------------------------------------------
-typedef HashTable NameIndex;
+typedef struct NameIndex {
+    HashTable *elements;     // Name elements by name key.
+    PostingList *postings;   // Record ids of the elements.
+} NameIndex;
 
 // Interface to NameIndex.
 //--------------------------------------------------------------------------------------------------
 NameIndex *createNameIndex(void);
 void deleteNameIndex(NameIndex *index);
-void insertInNameIndex(NameIndex *index, String nameKey, String personKey);
+void insertInNameIndex(NameIndex *index, String nameKey, RecordId id);
+void sortNameIndex(NameIndex *index);
+void mergeNameIndex(NameIndex *index, NameIndex *partial);
+int sizeNameIndex(NameIndex *index);
 void showNameIndex(NameIndex *index);
-Set *searchNameIndex(NameIndex *index, String name);
+RecordId *searchNameIndex(NameIndex *index, String name, int *count);
+RecordId *searchNameIndexByKey(NameIndex *index, String nameKey, int *count);
 
 #endif // nameindex_h
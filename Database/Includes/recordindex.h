@@ -4,20 +4,66 @@
 //  recordindex.h -- Defines the record index as a hash table.
 //
 //  Created by Thomas Wetmore on 29 November 2022.
-//  Last changed on 17 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef recordindex_h
 #define recordindex_h
 
+#include <stdint.h>
+
+//  RecordId -- Dense id of a record in its database. Records are given ids 0, 1, 2, ... in the
+//    order they are stored, whatever their keys and types are. It and the posting lists are
+//    defined before the includes, since gnode.h includes database.h, whose name and surname
+//    indexes use them.
+//--------------------------------------------------------------------------------------------------
+typedef uint32_t RecordId;
+#define NORECORDID ((RecordId) UINT32_MAX)  // Id of a record that isn't in a database.
+
+//  IdGroup -- The location of a group of record ids in the array of a posting list. The name and
+//    surname indexes have a group for each name key or surname.
+//--------------------------------------------------------------------------------------------------
+typedef struct IdGroup {
+	int offset;  // Index of the group's first record id in the array.
+	int count;   // Number of record ids, sorted and without duplicates.
+	int fill;    // Used while the postings are being sorted.
+} IdGroup;
+
+//  Posting -- A (group, record id) pair not yet sorted into a posting list's array.
+//--------------------------------------------------------------------------------------------------
+typedef struct Posting {
+	IdGroup *group;  // Group the id belongs to.
+	RecordId id;     // Record id.
+} Posting;
+
+//  PostingList -- The record ids of a set of groups in one array, and the postings not yet sorted
+//    into it. Insertions are collected as postings and sorted into the array together.
+//--------------------------------------------------------------------------------------------------
+typedef struct PostingList {
+	RecordId *ids;       // Record ids of the groups.
+	int numIds;          // Number of record ids.
+	Posting *postings;   // Postings not yet sorted into ids.
+	int numPostings;     // Number of postings.
+	int maxPostings;     // Size of the postings array.
+} PostingList;
+
 #include "gnode.h"
 #include "hashtable.h"
 
-//  RecordIndexEl -- An element of a record index bucket.
+typedef struct NameForms NameForms;
+
+//  RecordIndexEl -- An element of a record index bucket. In a lazy database a record is not read
+//    until it is first needed; until then root is null and start and end locate the record's
+//    text in the mapped Gedcom file.
 //--------------------------------------------------------------------------------------------------
 typedef struct RecordIndexEl {
-	GNode *root;  //  The root node of the record.
+	GNode *root;  //  The root node of the record; null if the record has not been read.
 	int lineNumber;  // Line number in original Gedcom file where the root node is located.
+	String key;   // Key of the record; not owned by the element.
+	String start; // Start of the record's text if it has not been read.
+	String end;   // End of the record's text if it has not been read.
+	RecordId id;  // Id of the record in its database.
+	NameForms *nameForms;  // Forms of a person's first NAME line once made; owned.
 }  RecordIndexEl;
 
 //  RecordIndex -- A record index is a hash table.
@@ -28,8 +74,16 @@ typedef HashTable RecordIndex;
 //--------------------------------------------------------------------------------------------------
 RecordIndex *createRecordIndex(void);                   //  Create a record index.
 void deleteRecordIndex(RecordIndex*);                   //  Delete a record index.
-void insertInRecordIndex(RecordIndex*, String, GNode*, int lineNumber); //  Add an entry to a RecordIndex.
-GNode* searchRecordIndex(RecordIndex*, String);         //  Search for an entry in a RecordIndex.
+RecordIndexEl *insertInRecordIndex(RecordIndex*, String, GNode*, int lineNumber); //  Add an entry to a RecordIndex.
+RecordIndexEl *insertUnreadInRecordIndex(RecordIndex*, String key, String start, String end, int lineNumber); // Add an unread record.
 void showRecordIndex(RecordIndex*);                     //  Show the contents of record index.
 
+// User interface to PostingList.
+//--------------------------------------------------------------------------------------------------
+PostingList *createPostingList(void);  // Create an empty posting list.
+void deletePostingList(PostingList*);  // Delete a posting list.
+void addPosting(PostingList*, IdGroup*, RecordId);  // Add a record id to a group.
+void sortPostingList(PostingList*, IdGroup **groups, int numGroups);  // Sort postings into ids.
+int uniqueIds(RecordId*, int count);  // Sort a group of ids and remove its duplicates.
+
 #endif // recordindex_h
@@ -0,0 +1,26 @@
+//
+//  DeadEnds
+//
+//  snapshot.h -- Header file for database snapshots. A snapshot is a binary file that holds the
+//    records and name indexes of a database, so a database can be loaded without reading, parsing
+//    and normalizing its Gedcom file and without indexing its names again.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#ifndef snapshot_h
+#define snapshot_h
+
+#include "standard.h"
+#include "database.h"
+#include "import.h"
+#include "errors.h"
+
+#define SNAPSHOTVERSION 3
+
+bool saveSnapshot(Database*, String snapshotFile);  // Write a database to a snapshot file.
+Database *loadSnapshot(String snapshotFile, String gedcomFile);  // Load a snapshot if it is current.
+Database *loadDatabase(String gedcomFile, String snapshotFile, ImportOptions*, ErrorLog*);  // Load a snapshot or import.
+
+#endif // snapshot_h
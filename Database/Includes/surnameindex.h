@@ -0,0 +1,48 @@
+//
+//  DeadEnds
+//
+//  surnameindex.h -- Header file for the surname index, a sorted dictionary of the surnames of
+//    the persons in a database. It finds the persons whose surnames start with a prefix, for
+//    lookups made as a user types.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#ifndef surnameindex_h
+#define surnameindex_h
+
+#include <stdint.h>
+#include "hashtable.h"
+#include "recordindex.h"
+
+//  SurnameElement -- A surname and the location of the record ids of the persons who have it.
+//--------------------------------------------------------------------------------------------------
+typedef struct {
+	String surname;  // Surname in upper case; owned by the element.
+	IdGroup group;   // Record ids of the persons with the surname.
+} SurnameElement;
+
+//  SurnameIndex -- The surname elements in a hash table and in surname order, and the record ids
+//    of all elements in one posting list in the same order. The ids of the surnames with a prefix
+//    are together in the list's array.
+//--------------------------------------------------------------------------------------------------
+typedef struct SurnameIndex {
+	HashTable *elements;        // Surname elements by surname.
+	SurnameElement **sorted;    // Surname elements in surname order.
+	int numSorted;              // Number of sorted elements.
+	PostingList *postings;      // Record ids of the elements.
+} SurnameIndex;
+
+SurnameIndex *createSurnameIndex(void);  // Create a surname index.
+void deleteSurnameIndex(SurnameIndex*);  // Delete a surname index.
+void insertInSurnameIndex(SurnameIndex*, String surname, RecordId);  // Add a surname of a person.
+void mergeSurnameIndex(SurnameIndex*, SurnameIndex *partial);  // Add the entries of another index.
+void sortSurnameIndex(SurnameIndex*);  // Sort the postings into the index.
+int sizeSurnameIndex(SurnameIndex*);  // Return the number of surnames.
+SurnameElement **surnamesWithPrefix(SurnameIndex*, String prefix, int *count);  // Find surnames.
+RecordId *searchSurnamePrefix(SurnameIndex*, String prefix, int *count);  // Persons by prefix.
+RecordId *personsWithSurnamePrefix(SurnameIndex*, String prefix, int *count);  // Unique, sorted.
+RecordId *searchSurnameIndex(SurnameIndex*, String surname, int *count);  // Persons by surname.
+
+#endif // surnameindex_h
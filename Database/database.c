@@ -7,19 +7,28 @@
 //    records is also done.
 //
 //  Created by Thomas Wetmore on 10 November 2022.
-//  Last changed 22 November 2023.
+//  Last changed 17 October 2026.
 //
 
+#include <stdatomic.h>
+#include <pthread.h>
 #include "database.h"
 #include "gnode.h"
 #include "name.h"
 #include "recordindex.h"
 #include "stringtable.h"
 #include "nameindex.h"
+#include "surnameindex.h"
 #include "path.h"
+#include "import.h"
 
 static bool debugging = false;
 
+//  minPersonsPerThread -- Fewest persons worth giving a thread to index. Tests lower it so that
+//    small databases are split.
+//--------------------------------------------------------------------------------------------------
+int minPersonsPerThread = 20000;
+
 //  createDatabase -- Create a database.
 //--------------------------------------------------------------------------------------------------
 Database *createDatabase(String fileName)
@@ -33,20 +42,74 @@ Database *createDatabase(String fileName)
 	database->eventIndex = createRecordIndex();
 	database->otherIndex = createRecordIndex();
 	database->nameIndex = createNameIndex();
+	database->surnameIndex = createSurnameIndex();
+	database->mappedFile = null;
+	database->arena = null;
+	database->nodeStore = null;
+	database->valuePool = null;
+	database->lazyErrorLog = null;
+	database->foldedValues = false;
+	database->records = null;
+	database->numRecords = database->maxRecords = 0;
 	return database;
 }
 
-//  deleteDatabase -- Delete a database.
+//  reserveDatabase -- Make room in the record indexes of a database for the records it will get.
+//--------------------------------------------------------------------------------------------------
+void reserveDatabase(Database *database, RecordCounts *counts)
+{
+	ASSERT(database && counts);
+	reserveHashTable(database->personIndex, counts->persons);
+	reserveHashTable(database->familyIndex, counts->families);
+	reserveHashTable(database->sourceIndex, counts->sources);
+	reserveHashTable(database->eventIndex, counts->events);
+	reserveHashTable(database->otherIndex, counts->others);
+}
+
+//  freeRecords -- Free the node trees of the records in a record index. Nodes that point into a
+//    mapped file do not own their keys and values; nodes with interned values do not own their
+//    values.
+//--------------------------------------------------------------------------------------------------
+static void freeRecords(RecordIndex *index, Database *database)
+{
+	FORHASHTABLE(index, element)
+		GNode *root = ((RecordIndexEl*) element)->root;
+		if (!root) continue;  // Not read in a lazy database.
+		if (database->mappedFile) freeGNodesInPlace(root);
+		else if (database->valuePool) freeInternedGNodes(root);
+		else freeGNodes(root);
+	ENDHASHTABLE
+}
+
+//  deleteDatabase -- Delete a database and its records. Records in an arena are freed all at
+//    once with the arena; other records are freed one tree at a time.
 //--------------------------------------------------------------------------------------------------
 void deleteDatabase(Database *database)
 {
 	ASSERT(database);
+	if (!database->arena) {
+		freeRecords(database->personIndex, database);
+		freeRecords(database->familyIndex, database);
+		freeRecords(database->sourceIndex, database);
+		freeRecords(database->eventIndex, database);
+		freeRecords(database->otherIndex, database);
+	}
 	deleteRecordIndex(database->personIndex);
 	deleteRecordIndex(database->familyIndex);
 	deleteRecordIndex(database->sourceIndex);
 	deleteRecordIndex(database->eventIndex);
 	deleteRecordIndex(database->otherIndex);
 	deleteNameIndex(database->nameIndex);
+	deleteSurnameIndex(database->surnameIndex);
+	if (database->records) stdfree(database->records);
+	if (database->nodeStore) deleteNodeStore(database->nodeStore);
+	if (database->arena) deleteArena(database->arena);
+	if (database->valuePool) deleteInternPool(database->valuePool);
+	if (database->lazyErrorLog) deleteErrorLog(database->lazyErrorLog);
+	if (database->mappedFile) deleteMappedFile(database->mappedFile);
+	stdfree(database->fileName);
+	stdfree(database->lastSegment);
+	stdfree(database);
 }
 
 //  keyMap -- Table that maps original keys to mapped keys. It is created the first time
@@ -89,6 +152,16 @@ int numberOthers(Database *database)
 	return sizeHashTable(database->otherIndex);
 }
 
+//  elementToRecord -- Return the record of a record index element. In a lazy database the record
+//    is read from the mapped Gedcom file the first time it is needed. Returns null if the record
+//    could not be read.
+//--------------------------------------------------------------------------------------------------
+GNode *elementToRecord(RecordIndexEl *element, Database *database)
+{
+	if (!element->root && element->start) element->root = readUnreadRecord(element, database);
+	return element->root;
+}
+
 //  keyToPerson -- Get a person record from a database.
 //--------------------------------------------------------------------------------------------------
 GNode* keyToPerson(String key, Database *database)
@@ -96,7 +169,7 @@ GNode* keyToPerson(String key, Database *database)
 //  index -- Record index to search for the person.
 {
 	RecordIndexEl* element = (RecordIndexEl*) searchHashTable(database->personIndex, key);
-	return element ? element->root : null;
+	return element ? elementToRecord(element, database) : null;
 }
 
 //  keyToFamily -- Get a family record from a record index.
@@ -107,7 +180,7 @@ GNode* keyToFamily(String key, Database *database)
 {
 	//if (debugging) printf("keyToFamily called with key: %s\n", key);
 	RecordIndexEl *element = (RecordIndexEl*) searchHashTable(database->familyIndex, key);
-	return element == null ? null : element->root;
+	return element == null ? null : elementToRecord(element, database);
 }
 
 //  keyToSource -- Get a source record from the database.
@@ -115,7 +188,7 @@ GNode* keyToFamily(String key, Database *database)
 GNode *keyToSource(String key, Database *database)
 {
 	RecordIndexEl* element = (RecordIndexEl*) searchHashTable(database->sourceIndex, key);
-	return element ? element->root : null;
+	return element ? elementToRecord(element, database) : null;
 }
 
 //  keyToEvent -- Get an event record from a database.
@@ -123,10 +196,10 @@ GNode *keyToSource(String key, Database *database)
 GNode *keyToEvent(String key, Database *database)
 {
 	RecordIndexEl *element = (RecordIndexEl*) searchHashTable(database->eventIndex, key);
-	return element ? element->root : null;
+	return element ? elementToRecord(element, database) : null;
 }
 
-static int count = 0;  // Debugging.
+static atomic_int count = 0;  // Debugging.
 
 //  storeRecord -- Store a Gedcom node tree in the database by adding it to the record index of
 //    its type. Return true if the record was added successfully.
@@ -144,26 +217,118 @@ bool storeRecord(Database *database, GNode* root, int lineNumber)
 	ASSERT(root->key);
 	count++;
 	String key = root->key;  // MNOTE: insertInRecord copies the key.
+	RecordIndex *index = null;
 	switch (type) {
-		case GRPerson:
-			insertInRecordIndex(database->personIndex, key, root, lineNumber);
-			return true;
-		case GRFamily:
-			insertInRecordIndex(database->familyIndex, key, root, lineNumber);
-			return true;
-		case GRSource:
-			insertInRecordIndex(database->sourceIndex, key, root, lineNumber);
-			return true;
-		case GREvent:
-			insertInRecordIndex(database->eventIndex, key, root, lineNumber);
-			return true;
-		case GROther:
-			insertInRecordIndex(database->otherIndex, key, root, lineNumber);
-			return true;
+		case GRPerson: index = database->personIndex; break;
+		case GRFamily: index = database->familyIndex; break;
+		case GRSource: index = database->sourceIndex; break;
+		case GREvent: index = database->eventIndex; break;
+		case GROther: index = database->otherIndex; break;
 		default:
 			ASSERT(false);
 			return false;
 	}
+	RecordIndexEl *element = insertInRecordIndex(index, key, root, lineNumber);
+	if (element) assignRecordId(database, element);
+	return true;
+}
+
+//  assignRecordId -- Give the record of a new record index element the next id of its database.
+//--------------------------------------------------------------------------------------------------
+void assignRecordId(Database *database, RecordIndexEl *element)
+{
+	ASSERT(database && element && element->id == NORECORDID);
+	if (database->numRecords == database->maxRecords) {
+		int max = database->maxRecords ? 2*database->maxRecords : 1024;
+		RecordIndexEl **records = (RecordIndexEl**) stdalloc(max*sizeof(RecordIndexEl*));
+		if (database->records) {
+			memcpy(records, database->records, database->numRecords*sizeof(RecordIndexEl*));
+			stdfree(database->records);
+		}
+		database->records = records;
+		database->maxRecords = max;
+	}
+	element->id = (RecordId) database->numRecords;
+	database->records[database->numRecords++] = element;
+}
+
+//  keyToRecordId -- Return the id of the record with a key, or NORECORDID if there is none. The
+//    person index is searched first, then the family index, and then the others.
+//--------------------------------------------------------------------------------------------------
+RecordId keyToRecordId(String key, Database *database)
+{
+	ASSERT(key && database);
+	RecordIndex *indexes[] = {database->personIndex, database->familyIndex,
+		database->sourceIndex, database->eventIndex, database->otherIndex};
+	for (int i = 0; i < 5; i++) {
+		RecordIndexEl *element = (RecordIndexEl*) searchHashTable(indexes[i], key);
+		if (element) return element->id;
+	}
+	return NORECORDID;
+}
+
+//  recordIdToKey -- Return the key of the record with an id.
+//--------------------------------------------------------------------------------------------------
+String recordIdToKey(RecordId id, Database *database)
+{
+	ASSERT(database && id < database->numRecords);
+	return database->records[id]->key;
+}
+
+//  recordIdToRecord -- Return the root of the record with an id. In a lazy database the record is
+//    read if it hasn't been.
+//--------------------------------------------------------------------------------------------------
+GNode *recordIdToRecord(RecordId id, Database *database)
+{
+	ASSERT(database && id < database->numRecords);
+	return elementToRecord(database->records[id], database);
+}
+
+//  elementNameForms -- Return the forms of the first NAME line of the person of a record index
+//    element. They are made if they haven't been or if the person's NAME value is not the one
+//    they were made from. Returns null if the record has no name.
+//--------------------------------------------------------------------------------------------------
+static NameForms *elementNameForms(RecordIndexEl *element, Database *database)
+{
+	GNode *root = elementToRecord(element, database);
+	GNode *name = root ? NAME(root) : null;
+	NameForms *forms = element->nameForms;
+	if (forms && name && forms->source == name->value) return forms;
+	if (forms) deleteNameForms(forms);
+	element->nameForms = name && name->value ? createNameForms(name->value) : null;
+	return element->nameForms;
+}
+
+//  personToNameForms -- Return the forms of the first NAME line of a person, or null if the person
+//    has no name or is not in the database. The forms belong to the database.
+//--------------------------------------------------------------------------------------------------
+NameForms *personToNameForms(GNode *person, Database *database)
+{
+	ASSERT(person && database);
+	if (!person->key) return null;
+	RecordIndexEl *element = (RecordIndexEl*) searchHashTable(database->personIndex, person->key);
+	return element ? elementNameForms(element, database) : null;
+}
+
+//  recordIdToNameForms -- Return the forms of the first NAME line of the person with a record id,
+//    or null if the person has no name. The forms belong to the database.
+//--------------------------------------------------------------------------------------------------
+NameForms *recordIdToNameForms(RecordId id, Database *database)
+{
+	ASSERT(database && id < database->numRecords);
+	return elementNameForms(database->records[id], database);
+}
+
+//  invalidateNameForms -- Forget the name forms of a person. Code that changes a person's first
+//    NAME value in place, or frees it, must call this; a new value is noticed without it.
+//--------------------------------------------------------------------------------------------------
+void invalidateNameForms(String key, Database *database)
+{
+	ASSERT(key && database);
+	RecordIndexEl *element = (RecordIndexEl*) searchHashTable(database->personIndex, key);
+	if (!element || !element->nameForms) return;
+	deleteNameForms(element->nameForms);
+	element->nameForms = null;
 }
 
 // tableReport -- Debug function that reports on the sizes of the database tables.
@@ -177,40 +342,180 @@ void showTableSizes(Database *database)
 	printf("Size of otherIndex:  %d\n", sizeHashTable(database->otherIndex));
 }
 
-//  indexNames -- Index all person names in the database. This uses the hash table traverse
-//    functions on the person index. For each person all NAME node values are indexed.
+//  personIds -- Return the record ids of the persons in a database in id order, and set their
+//    number.
 //--------------------------------------------------------------------------------------------------
-void indexNames(Database* database)
+static RecordId *personIds(Database *database, int *count)
 {
-	int i, j;  //  State variables.
-	static int count = 0;
+	bool *isPerson = (bool*) stdalloc(database->numRecords + 1);
+	memset(isPerson, 0, database->numRecords + 1);
+	FORHASHTABLE(database->personIndex, element)
+		isPerson[((RecordIndexEl*) element)->id] = true;
+	ENDHASHTABLE
+	RecordId *ids = (RecordId*) stdalloc((sizeHashTable(database->personIndex) + 1)*sizeof(RecordId));
+	int n = 0;
+	for (RecordId id = 0; id < database->numRecords; id++)
+		if (isPerson[id]) ids[n++] = id;
+	stdfree(isPerson);
+	*count = n;
+	return ids;
+}
 
-	if (debugging) printf("Start indexNames\n");
+//  NameTask -- A range of persons whose names are indexed by one thread.
+//--------------------------------------------------------------------------------------------------
+typedef struct NameTask {
+	Database *database;  // Database of the persons.
+	RecordId *ids;       // Record ids of the persons, in order.
+	int count;           // Number of persons.
+	NameIndex *index;    // Index the names are added to.
+	SurnameIndex *surnames;  // Index the surnames are added to.
+	int numNames;        // Number of names indexed.
+	pthread_t thread;    // Thread that indexes the names.
+} NameTask;
 
-	//  Get the first entry in the person index.
-	RecordIndexEl* entry = firstInHashTable(database->personIndex, &i, &j);
-	while (entry) {
-		GNode* root = entry->root;
-		//  MNOTE: The key is heapified in insertInNameIndex.
-		String recordKey = root->key;
-		//  DEBUG
-		if (debugging) printf("indexNames: recordKey: %s\n", recordKey);
+//  indexNameTask -- Add the names of a range of persons to the task's name and surname indexes,
+//    and make the forms of their first NAME lines. The persons must have been read. Run by the
+//    threads of indexNamesInParallel; each thread makes the forms of its own persons.
+//--------------------------------------------------------------------------------------------------
+static void *indexNameTask(void *arg)
+{
+	NameTask *task = (NameTask*) arg;
+	for (int i = 0; i < task->count; i++) {
+		RecordIndexEl *element = task->database->records[task->ids[i]];
+		GNode* root = element->root;
+		if (!root) continue;
+		NameForms *forms = elementNameForms(element, task->database);
 		for (GNode* name = NAME(root); name && eqstr(name->tag, "NAME"); name = name->sibling) {
 			if (name->value) {
-				if (debugging) printf("indexNames: name->value: %s\n", name->value);
-				//  MNOTE: nameKey is in data space. It is heapified in insertInNameIndex.
-				String nameKey = nameToNameKey(name->value);
-				if (debugging) printf("indexNames: nameKey: %s\n", nameKey);
-				insertInNameIndex(database->nameIndex, nameKey, recordKey);
-				count++;
+				//  MNOTE: nameKey is in data space. It is copied by insertInNameIndex.
+				bool first = forms && name->value == forms->source;
+				insertInNameIndex(task->index, first ? forms->nameKey : nameToNameKey(name->value),
+								  task->ids[i]);
+				String surname = first ? forms->surname : getSurname(name->value);
+				if (nestr(surname, "____")) insertInSurnameIndex(task->surnames, surname, task->ids[i]);
+				task->numNames++;
 			}
 		}
+	}
+	return null;
+}
+
+//  indexNames -- Index all person names in the database. The name and surname indexes are
+//    rebuilt. The persons are visited in record id order, so the postings of each key are added
+//    in order and the indexes sort them with one counting sort. Returns the number of names
+//    indexed.
+//--------------------------------------------------------------------------------------------------
+int indexNames(Database* database)
+{
+	return indexNamesInParallel(database, 1);
+}
 
-		//  Get the next entry in the person index.
-		entry = nextInHashTable(database->personIndex, &i, &j);
+//  indexNamesInParallel -- Index all person names in the database using threads. The persons are
+//    split into ranges of record ids, and each thread builds a partial index of its range. The
+//    partial indexes are merged in order, so the result is the same as indexNames's. Unread
+//    persons in a lazy database are read first by the calling thread. Returns the number of names
+//    indexed.
+//--------------------------------------------------------------------------------------------------
+int indexNamesInParallel(Database* database, int numThreads)
+//  database -- Database whose names are indexed.
+//  numThreads -- Maximum number of threads to use, including the calling thread.
+{
+	if (debugging) printf("Start indexNames\n");
+	deleteNameIndex(database->nameIndex);
+	database->nameIndex = createNameIndex();
+	deleteSurnameIndex(database->surnameIndex);
+	database->surnameIndex = createSurnameIndex();
+	int numPersons;
+	RecordId *ids = personIds(database, &numPersons);
+	for (int i = 0; i < numPersons; i++) elementToRecord(database->records[ids[i]], database);
+
+	//  Don't give threads fewer than a minimum number of persons.
+	int numTasks = numPersons/(minPersonsPerThread > 0 ? minPersonsPerThread : 1) + 1;
+	if (numTasks > numThreads) numTasks = numThreads;
+	if (numTasks < 1) numTasks = 1;
+	NameTask *tasks = (NameTask*) stdalloc(numTasks*sizeof(NameTask));
+	for (int i = 0, start = 0; i < numTasks; i++) {
+		int end = (int) ((long) numPersons*(i + 1)/numTasks);
+		tasks[i] = (NameTask) {database, ids + start, end - start, null, null, 0};
+		tasks[i].index = i == 0 ? database->nameIndex : createNameIndex();
+		tasks[i].surnames = i == 0 ? database->surnameIndex : createSurnameIndex();
+		start = end;
+	}
+
+	//  Index the ranges. The calling thread does the first one, into the database's index.
+	for (int i = 1; i < numTasks; i++)
+		if (pthread_create(&tasks[i].thread, null, indexNameTask, tasks + i)) FATAL();
+	indexNameTask(tasks);
+	int count = tasks[0].numNames;
+	for (int i = 1; i < numTasks; i++) {
+		pthread_join(tasks[i].thread, null);
+		mergeNameIndex(database->nameIndex, tasks[i].index);
+		deleteNameIndex(tasks[i].index);
+		mergeSurnameIndex(database->surnameIndex, tasks[i].surnames);
+		deleteSurnameIndex(tasks[i].surnames);
+		count += tasks[i].numNames;
 	}
-	//showNameIndex(database->nameIndex);
-	/*if (debugging) */ printf("The number of names indexed was %d\n", count);
+	sortNameIndex(database->nameIndex);
+	sortSurnameIndex(database->surnameIndex);
+	stdfree(tasks);
+	stdfree(ids);
+	if (debugging) printf("The number of names indexed was %d with %d threads\n", count, numTasks);
+	return count;
+}
+
+//  resolveLinksInRecords -- Resolve the links of the records in a record index. Links are the
+//    children of the roots with one of the link tags; their values are the keys of records in the
+//    target index. Dangling links are added to the error log and left unresolved.
+//--------------------------------------------------------------------------------------------------
+static int resolveLinksInRecords(RecordIndex *index, String tags[], int numTags,
+								 GNode* (*keyToRecord)(String, Database*), Database *database,
+								 ErrorLog *errorLog)
+//  index -- Index of the records whose links are resolved.
+//  tags -- Tags of the link nodes.
+//  numTags -- Number of link tags.
+//  keyToRecord -- Function that returns the record a link refers to.
+//  database -- Database of the records.
+//  errorLog -- Error log for the dangling links.
+{
+	int count = 0;
+	char message[256];
+	FORHASHTABLE(index, element)
+		RecordIndexEl *indexEl = (RecordIndexEl*) element;
+		GNode *root = elementToRecord(indexEl, database);
+		if (!root) continue;
+		for (GNode *node = root->child; node; node = node->sibling) {
+			int i = 0;
+			while (i < numTags && nestr(node->tag, tags[i])) i++;
+			if (i == numTags) continue;
+			node->link = node->value ? keyToRecord(node->value, database) : null;
+			if (node->link) {
+				count++;
+				continue;
+			}
+			snprintf(message, sizeof(message), "%s link in record %s refers to no record: %s",
+					 node->tag, root->key, node->value ? node->value : "(no value)");
+			addErrorToLog(errorLog, createError(linkageError, database->fileName,
+												indexEl->lineNumber, message));
+		}
+	ENDHASHTABLE
+	return count;
+}
+
+//  resolveLinks -- Resolve the FAMC and FAMS links of the persons and the HUSB, WIFE and CHIL
+//    links of the families in a database, so that following a link does not look up its key.
+//    Returns the number of links resolved.
+//--------------------------------------------------------------------------------------------------
+int resolveLinks(Database *database, ErrorLog *errorLog)
+{
+	ASSERT(database);
+	static String personLinks[] = {"FAMC", "FAMS"};
+	static String familyLinks[] = {"HUSB", "WIFE", "CHIL"};
+	int count = resolveLinksInRecords(database->personIndex, personLinks, 2, keyToFamily,
+									  database, errorLog);
+	count += resolveLinksInRecords(database->familyIndex, familyLinks, 3, keyToPerson,
+								   database, errorLog);
+	if (debugging) printf("resolveLinks resolved %d links.\n", count);
+	return count;
 }
 
 //  Some debugging functions.
@@ -0,0 +1,271 @@
+//
+//  DeadEnds
+//
+//  fuzzyindex.c -- Implements the FuzzyIndex type. A search finds the names that share enough
+//    trigrams with the query to be within the edit distance, checks their edit distances, and
+//    keeps the best matches. Each edit changes at most three trigrams, so a name within distance
+//    d of the query shares all but 3d of the query's distinct trigrams and all but 3d of its own.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#include "fuzzyindex.h"
+#include "recordindex.h"
+#include "gedcom.h"
+
+static bool debugging = false;
+
+//  normalizeName -- Put a name in the form the fuzzy index uses: upper case letters separated by
+//    single spaces. Slashes, digits and other non letters separate words. Returns the length.
+//--------------------------------------------------------------------------------------------------
+int normalizeName(String name, String buffer)
+//  name -- Name to normalize; a Gedcom name or any other string.
+//  buffer -- Buffer of at least MAXFUZZYNAMELEN + 1 characters for the normalized name.
+{
+	int length = 0;
+	bool space = false;
+	for (int c; (c = (unsigned char) *name++) && length < MAXFUZZYNAMELEN;) {
+		if (isalpha(c) && c < 128) {
+			if (space && length) buffer[length++] = ' ';
+			if (length < MAXFUZZYNAMELEN) buffer[length++] = toupper(c);
+			space = false;
+		} else space = true;
+	}
+	buffer[length] = 0;
+	return length;
+}
+
+//  letterCode -- Return the code of a character of a normalized name: 0 for space, 1 to 26 for
+//    the letters.
+//--------------------------------------------------------------------------------------------------
+static inline int letterCode(int c) { return c == ' ' ? 0 : c - 'A' + 1; }
+
+//  getTrigrams -- Find the distinct trigrams of a normalized name, padded with two spaces at each
+//    end. Returns their number.
+//--------------------------------------------------------------------------------------------------
+static int getTrigrams(String name, int length, int *trigrams)
+//  name -- Normalized name.
+//  length -- Length of the name.
+//  trigrams -- (out) Array of at least MAXFUZZYNAMELEN + 2 trigrams.
+{
+	int count = 0;
+	for (int i = -2; i < length; i++) {
+		int a = i < 0 ? 0 : letterCode(name[i]);
+		int b = i + 1 < 0 || i + 1 >= length ? 0 : letterCode(name[i + 1]);
+		int c = i + 2 >= length ? 0 : letterCode(name[i + 2]);
+		int trigram = (a*27 + b)*27 + c;
+		bool seen = false;
+		for (int j = 0; j < count && !seen; j++) seen = trigrams[j] == trigram;
+		if (!seen) trigrams[count++] = trigram;
+	}
+	return count;
+}
+
+//  addName -- Add a normalized name to the names of a fuzzy index being built.
+//--------------------------------------------------------------------------------------------------
+static void addName(FuzzyIndex *index, RecordId person, String name, int length, int *maxNames,
+					int *textLength, int *maxText)
+{
+	if (index->numNames == *maxNames) {
+		*maxNames = *maxNames ? 2*(*maxNames) : 1024;
+		RecordId *persons = (RecordId*) stdalloc(*maxNames*sizeof(RecordId));
+		int *nameOffsets = (int*) stdalloc((*maxNames + 1)*sizeof(int));
+		if (index->numNames) {
+			memcpy(persons, index->persons, index->numNames*sizeof(RecordId));
+			memcpy(nameOffsets, index->nameOffsets, index->numNames*sizeof(int));
+			stdfree(index->persons);
+			stdfree(index->nameOffsets);
+		}
+		index->persons = persons;
+		index->nameOffsets = nameOffsets;
+	}
+	if (*textLength + length + 1 > *maxText) {
+		while (*textLength + length + 1 > *maxText) *maxText = *maxText ? 2*(*maxText) : 65536;
+		String text = (String) stdalloc(*maxText);
+		if (*textLength) {
+			memcpy(text, index->text, *textLength);
+			stdfree(index->text);
+		}
+		index->text = text;
+	}
+	index->persons[index->numNames] = person;
+	index->nameOffsets[index->numNames++] = *textLength;
+	memcpy(index->text + *textLength, name, length + 1);
+	*textLength += length + 1;
+}
+
+//  createFuzzyIndex -- Build the fuzzy name index of a database. All the NAME values of all the
+//    persons are indexed. The index does not change when the database does.
+//--------------------------------------------------------------------------------------------------
+FuzzyIndex *createFuzzyIndex(Database *database)
+{
+	ASSERT(database);
+	FuzzyIndex *index = (FuzzyIndex*) stdalloc(sizeof(FuzzyIndex));
+	memset(index, 0, sizeof(FuzzyIndex));
+	index->database = database;
+
+	//  Collect the normalized names.
+	int maxNames = 0, textLength = 0, maxText = 0;
+	char name[MAXFUZZYNAMELEN + 1];
+	FORHASHTABLE(database->personIndex, element)
+		RecordIndexEl *recordEl = (RecordIndexEl*) element;
+		GNode *root = elementToRecord(recordEl, database);
+		if (!root) continue;
+		for (GNode *node = NAME(root); node && eqstr(node->tag, "NAME"); node = node->sibling) {
+			if (!node->value) continue;
+			int length = normalizeName(node->value, name);
+			if (length) addName(index, recordEl->id, name, length, &maxNames, &textLength, &maxText);
+		}
+	ENDHASHTABLE
+
+	//  Count the names with each trigram, then add them.
+	int numNames = index->numNames;
+	int trigrams[MAXFUZZYNAMELEN + 2];
+	index->numTrigrams = (short*) stdalloc((numNames + 1)*sizeof(short));
+	index->offsets = (int*) stdalloc((NUMTRIGRAMS + 1)*sizeof(int));
+	memset(index->offsets, 0, (NUMTRIGRAMS + 1)*sizeof(int));
+	for (int i = 0; i < numNames; i++) {
+		String text = index->text + index->nameOffsets[i];
+		int count = getTrigrams(text, (int) strlen(text), trigrams);
+		index->numTrigrams[i] = count;
+		for (int j = 0; j < count; j++) index->offsets[trigrams[j] + 1]++;
+	}
+	for (int t = 0; t < NUMTRIGRAMS; t++) index->offsets[t + 1] += index->offsets[t];
+	index->postings = (int*) stdalloc((index->offsets[NUMTRIGRAMS] + 1)*sizeof(int));
+	int *cursors = (int*) stdalloc(NUMTRIGRAMS*sizeof(int));
+	memcpy(cursors, index->offsets, NUMTRIGRAMS*sizeof(int));
+	for (int i = 0; i < numNames; i++) {
+		String text = index->text + index->nameOffsets[i];
+		int count = getTrigrams(text, (int) strlen(text), trigrams);
+		for (int j = 0; j < count; j++) index->postings[cursors[trigrams[j]]++] = i;
+	}
+	stdfree(cursors);
+	index->counts = (int*) stdalloc((numNames + 1)*sizeof(int));
+	memset(index->counts, 0, (numNames + 1)*sizeof(int));
+	index->touched = (int*) stdalloc((numNames + 1)*sizeof(int));
+	if (debugging) printf("Fuzzy index: %d names, %d postings\n", numNames,
+						  index->offsets[NUMTRIGRAMS]);
+	return index;
+}
+
+//  deleteFuzzyIndex -- Delete a fuzzy name index. The database is not changed.
+//--------------------------------------------------------------------------------------------------
+void deleteFuzzyIndex(FuzzyIndex *index)
+{
+	ASSERT(index);
+	if (index->persons) stdfree(index->persons);
+	if (index->nameOffsets) stdfree(index->nameOffsets);
+	if (index->text) stdfree(index->text);
+	stdfree(index->numTrigrams);
+	stdfree(index->offsets);
+	stdfree(index->postings);
+	stdfree(index->counts);
+	stdfree(index->touched);
+	stdfree(index);
+}
+
+//  editDistance -- Return the edit distance between two strings, or maxDistance + 1 if it is
+//    greater than maxDistance.
+//--------------------------------------------------------------------------------------------------
+static int editDistance(String a, int lengthA, String b, int lengthB, int maxDistance)
+{
+	if (abs(lengthA - lengthB) > maxDistance) return maxDistance + 1;
+	int rows[2][MAXFUZZYNAMELEN + 1];
+	int *previous = rows[0], *current = rows[1];
+	for (int j = 0; j <= lengthB; j++) previous[j] = j;
+	for (int i = 1; i <= lengthA; i++) {
+		current[0] = i;
+		int smallest = i;
+		for (int j = 1; j <= lengthB; j++) {
+			int cost = previous[j - 1] + (a[i - 1] != b[j - 1]);
+			if (previous[j] + 1 < cost) cost = previous[j] + 1;
+			if (current[j - 1] + 1 < cost) cost = current[j - 1] + 1;
+			current[j] = cost;
+			if (cost < smallest) smallest = cost;
+		}
+		if (smallest > maxDistance) return maxDistance + 1;
+		int *swap = previous; previous = current; current = swap;
+	}
+	return previous[lengthB] > maxDistance ? maxDistance + 1 : previous[lengthB];
+}
+
+//  betterMatch -- Return whether one match ranks before another: smaller distance first, then
+//    greater similarity, then file order.
+//--------------------------------------------------------------------------------------------------
+static bool betterMatch(FuzzyMatch *a, FuzzyMatch *b)
+{
+	if (a->distance != b->distance) return a->distance < b->distance;
+	if (a->similarity != b->similarity) return a->similarity > b->similarity;
+	return a->id < b->id;
+}
+
+//  addMatch -- Add a match to the ranked matches if it is good enough. A person is kept once,
+//    with the best of its names. Returns the new number of matches.
+//--------------------------------------------------------------------------------------------------
+static int addMatch(FuzzyMatch *matches, int count, int topK, FuzzyMatch match)
+{
+	for (int i = 0; i < count; i++) {
+		if (matches[i].id != match.id) continue;
+		if (!betterMatch(&match, matches + i)) return count;
+		memmove(matches + i, matches + i + 1, (count - i - 1)*sizeof(FuzzyMatch));
+		count--;
+		break;
+	}
+	if (count == topK && !betterMatch(&match, matches + count - 1)) return count;
+	int i = count < topK ? count++ : count - 1;
+	for (; i > 0 && betterMatch(&match, matches + i - 1); i--) matches[i] = matches[i - 1];
+	matches[i] = match;
+	return count;
+}
+
+//  searchFuzzyIndex -- Find the persons with names within an edit distance of a name, best first.
+//    Returns the number found. A short query, with no more than 3*maxDistance trigrams, may be
+//    near names it shares no trigram with, so all names are checked. The index's scratch arrays
+//    are used, so one index cannot be searched by two threads at once.
+//--------------------------------------------------------------------------------------------------
+int searchFuzzyIndex(FuzzyIndex *index, String name, int maxDistance, int topK,
+					 FuzzyMatch *matches)
+//  index -- Fuzzy index to search.
+//  name -- Name to search for; it is normalized.
+//  maxDistance -- Greatest edit distance of the names found.
+//  topK -- Greatest number of persons to return.
+//  matches -- (out) Array of at least topK matches.
+{
+	ASSERT(index && name && maxDistance >= 0 && matches);
+	if (topK <= 0) return 0;
+	char query[MAXFUZZYNAMELEN + 1];
+	int length = normalizeName(name, query);
+	if (length == 0) return 0;
+	int trigrams[MAXFUZZYNAMELEN + 2];
+	int numTrigrams = getTrigrams(query, length, trigrams);
+
+	//  Count the trigrams each name shares with the query.
+	int numTouched = 0;
+	for (int j = 0; j < numTrigrams; j++) {
+		int *posting = index->postings + index->offsets[trigrams[j]];
+		int *end = index->postings + index->offsets[trigrams[j] + 1];
+		for (; posting < end; posting++) {
+			if (index->counts[*posting]++ == 0) index->touched[numTouched++] = *posting;
+		}
+	}
+
+	//  Check the edit distances of the names that share enough trigrams, and clear the counts.
+	bool checkAll = numTrigrams <= 3*maxDistance;
+	int numChecked = checkAll ? index->numNames : numTouched;
+	int count = 0;
+	for (int i = 0; i < numChecked; i++) {
+		int n = checkAll ? i : index->touched[i];
+		int shared = index->counts[n];
+		index->counts[n] = 0;
+		int most = numTrigrams > index->numTrigrams[n] ? numTrigrams : index->numTrigrams[n];
+		if (shared < most - 3*maxDistance) continue;
+		String text = index->text + index->nameOffsets[n];
+		int distance = editDistance(query, length, text, (int) strlen(text), maxDistance);
+		if (distance > maxDistance) continue;
+		FuzzyMatch match = {index->persons[n], distance,
+			(double) shared/(numTrigrams + index->numTrigrams[n] - shared)};
+		count = addMatch(matches, count, topK, match);
+	}
+	return count;
+}
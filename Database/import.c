@@ -4,9 +4,12 @@
 //  import.c -- Read Gedcom files and build a database from them.
 //
 //  Created by Thomas Wetmore on 13 November 2022.
-//  Last changed on 19 November 2023.
+//  Last changed on 17 October 2026.
 //
 
+#include <limits.h>
+#include <pthread.h>
+#include <zlib.h>
 #include "standard.h"
 #include "import.h"
 #include "gnode.h"
@@ -18,6 +21,8 @@
 #include "validate.h"
 #include "errors.h"
 #include "readnode.h"
+#include "utils.h"
+#include "boundedqueue.h"
 
 String currentGedcomFileName = null;
 int currentGedcomLineNumber = 1;
@@ -29,12 +34,16 @@ static void outputErrorLog(ErrorLog* errorLog);
 static void setupDatabase(List *recordIndexes);
 static void addIndexToDatabase(RecordIndex *index, Database *database);
 
-Database *importFromFile(String, ErrorLog*);
-
 // Error messages defined elsewhere.
 extern String idgedf, gdcker, gdnadd, dboldk, dbnewk, dbodel, cfoldk, dbdelk, dbrdon;
 
 static GNode *normalizeNodeTree (GNode*);
+static Database *importInParallel(String, ImportOptions*, ErrorLog*);
+static Database *importSequentially(String, ImportOptions*, ErrorLog*);
+static Database *importPipelined(String, ImportOptions*, ErrorLog*);
+static Database *importLazily(String, ImportStats*, ErrorLog*);
+static bool isGzipFile(String);
+static void presizeDatabase(Database*, String, MappedFile*, ImportStats*);
 static bool debugging = true;
 
 //  importFromFiles -- Import Gedcom files into a list of Databases.
@@ -54,34 +63,930 @@ List *importFromFiles(String fileNames[], int count, ErrorLog *errorLog)
 	return listOfDatabases;
 }
 
-//  importFromFile -- Import the records in a Gedcom file into a Database.
+//  importFromFile -- Import the records in a Gedcom file into a Database using the default
+//    options.
 //--------------------------------------------------------------------------------------------------
 Database *importFromFile(String fileName, ErrorLog *errorLog)
+{
+	return importFromFileWithOptions(fileName, null, errorLog);
+}
+
+//  importFromFileWithOptions -- Import the records in a Gedcom file into a Database. Names are
+//    indexed and the database is validated if the options ask for it. If the options have a stats
+//    struct it is filled in.
+//--------------------------------------------------------------------------------------------------
+Database *importFromFileWithOptions(String fileName, ImportOptions *options, ErrorLog *errorLog)
+//  fileName -- Name of the Gedcom file to import.
+//  options -- Import options; null for the defaults.
+//  errorLog -- Error log.
 {
 	if (debugging) printf("Entered importFromFile\n");
 	ASSERT(fileName);
+	ImportStats *stats = options ? options->stats : null;
+	if (stats) memset(stats, 0, sizeof(ImportStats));
+	int numErrors = lengthList(errorLog);
+	double startTime = getseconds();
+
+	Database *database;
+	if (isGzipFile(fileName))
+		database = importPipelined(fileName, options, errorLog);
+	else if (options && options->lazy)
+		database = importLazily(fileName, stats, errorLog);
+	else if (options && options->numThreads > 1)
+		database = importInParallel(fileName, options, errorLog);
+	else if (options && options->pipelined)
+		database = importPipelined(fileName, options, errorLog);
+	else
+		database = importSequentially(fileName, options, errorLog);
+
+	if (database && options) database->foldedValues = options->foldContinuations;
+	if (database && options && options->resolveLinks) {
+		double time = getseconds();
+		int linksResolved = resolveLinks(database, errorLog);
+		if (stats) {
+			stats->linksResolved = linksResolved;
+			stats->resolveLinksTime = getseconds() - time;
+		}
+	}
+	if (database && options && options->buildNameIndex) {
+		double time = getseconds();
+		int namesIndexed = indexNamesInParallel(database, options->numThreads);
+		if (stats) {
+			stats->namesIndexed = namesIndexed;
+			stats->indexNamesTime = getseconds() - time;
+		}
+	}
+	if (database && options && options->validate) {
+		double time = getseconds();
+		validateDatabase(database, errorLog);
+		if (stats) stats->validateTime = getseconds() - time;
+	}
+	if (stats) {
+		stats->totalTime = getseconds() - startTime;
+		stats->numErrors = lengthList(errorLog) - numErrors;
+	}
+	return database;
+}
+
+//  isGzipFile -- Return whether a file starts with the gzip magic number.
+//--------------------------------------------------------------------------------------------------
+static bool isGzipFile(String fileName)
+{
 	FILE *file = fopen(fileName, "r");
-	if (!file) {
+	if (!file) return false;
+	unsigned char magic[2];
+	bool gzipped = fread(magic, 1, 2, file) == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+	fclose(file);
+	return gzipped;
+}
+
+//  countRecord -- Count the record that starts with a level 0 line. The line must have a key;
+//    HEAD and TRLR records are not counted.
+//--------------------------------------------------------------------------------------------------
+static void countRecord(String p, String end, RecordCounts *counts)
+//  p -- Position in the level 0 line after the level.
+//  end -- End of the file's text.
+//  counts -- Counts to update.
+{
+	while (p < end && (*p == ' ' || *p == '\t')) p++;
+	if (p >= end || *p != '@') return;
+	p++;
+	while (p < end && *p != '@' && *p != '\n') p++;
+	if (p >= end || *p != '@') return;
+	p++;
+	while (p < end && (*p == ' ' || *p == '\t')) p++;
+	char tag[8];
+	int length = 0;
+	while (p < end && !iswhite(*p) && *p != '\r' && *p != '\n') {
+		if (length == sizeof(tag) - 1) return;  // Longer than any record tag.
+		tag[length++] = *p++;
+	}
+	tag[length] = 0;
+	switch (tagToRecordType(tag)) {
+		case GRPerson: counts->persons++; break;
+		case GRFamily: counts->families++; break;
+		case GRSource: counts->sources++; break;
+		case GREvent: counts->events++; break;
+		case GROther: counts->others++; break;
+		default: break;
+	}
+}
+
+//  countRecords -- Count the records of each type in the text of a Gedcom file. Only lines that
+//    start with a 0 are looked at; the rest are skipped by finding their newlines.
+//--------------------------------------------------------------------------------------------------
+void countRecords(String p, String end, RecordCounts *counts)
+//  p -- Start of the file's text.
+//  end -- End of the file's text.
+//  counts -- (out) Number of records of each type.
+{
+	memset(counts, 0, sizeof(RecordCounts));
+	while (p < end) {
+		if (*p == '0' && p + 1 < end && iswhite(p[1])) countRecord(p + 1, end, counts);
+		String newline = memchr(p, '\n', end - p);
+		if (!newline) break;
+		p = newline + 1;
+	}
+}
+
+//  presizeDatabase -- Count the records in a Gedcom file and size the record indexes of a
+//    database for them, so the indexes don't grow while the records are stored. The file is
+//    mapped for the count if it isn't already. The time taken is reported in the stats.
+//--------------------------------------------------------------------------------------------------
+static void presizeDatabase(Database *database, String fileName, MappedFile *mappedFile,
+							ImportStats *stats)
+//  database -- Database whose indexes are sized.
+//  fileName -- Name of the Gedcom file.
+//  mappedFile -- Mapping of the file; null if it isn't mapped.
+//  stats -- Import stats; can be null.
+{
+	double time = getseconds();
+	MappedFile *file = mappedFile ? mappedFile : createMappedFile(fileName);
+	if (!file) return;  // The import reports files that can't be read.
+	RecordCounts counts;
+	countRecords(file->data, file->data + file->size, &counts);
+	if (file != mappedFile) deleteMappedFile(file);
+	reserveDatabase(database, &counts);
+	if (debugging)
+		printf("Prescan found %d persons, %d families, %d sources, %d events, %d others.\n",
+			   counts.persons, counts.families, counts.sources, counts.events, counts.others);
+	if (stats) stats->prescanTime = getseconds() - time;
+}
+
+//  importSequentially -- Import the records in a Gedcom file into a Database on this thread.
+//--------------------------------------------------------------------------------------------------
+static Database *importSequentially(String fileName, ImportOptions *options, ErrorLog *errorLog)
+{
+	//  Each import has its own reader, so imports can run on different threads at the same time.
+	GedcomReader *reader = null;
+	MappedFile *mappedFile = null;
+	if (options && options->useMapping) {
+		if ((mappedFile = createMappedFile(fileName))) {
+			reader = createMappedGedcomReader(mappedFile);
+			reader->fileName = fileName;
+		}
+	} else
+		reader = createGedcomReader(fileName);
+	if (!reader) {
 		addErrorToLog(errorLog, createError(systemError, fileName, 0, "Could not open file."));
 		return null;
 	}
 
 	Database *database = createDatabase(fileName);
-	int recordCount = 0;  // DEBUG: Remove after testing.
+	database->mappedFile = mappedFile;  // The nodes point into the mapping if there is one.
+	if (options && options->useArena) reader->arena = database->arena = createArena(0);
+	if (options && options->prescan) presizeDatabase(database, fileName, mappedFile, options->stats);
+	if (options && options->internValues && !mappedFile)
+		reader->pool = database->valuePool = createInternPool();
+	if (options) {
+		reader->foldContinuations = options->foldContinuations;
+		reader->skipBadRecords = options->skipBadRecords;
+	}
+	int recordCount = 0;
 	int lineNo;
 
-	//  Read the records and add them to the database.
-	GNode *root = firstNodeTreeFromFile(file, &lineNo, errorLog);
-	while (root) {
-		recordCount++;  // DEBUG: Remove after testing.
-		storeRecord(database, normalizeNodeTree(root), lineNo);
-		root = nextNodeTreeFromFile(file, &lineNo, errorLog);
+	//  Read the records and add them to the database, timing each phase.
+	GNode *root;
+	double parseTime = 0, normalizeTime = 0, storeTime = 0;
+	double time = getseconds();
+	while ((root = readNodeTree(reader, &lineNo, errorLog))) {
+		double parsed = getseconds();
+		root = normalizeNodeTree(root);
+		double normalized = getseconds();
+		storeRecord(database, root, lineNo);
+		double stored = getseconds();
+		parseTime += parsed - time;
+		normalizeTime += normalized - parsed;
+		storeTime += stored - normalized;
+		time = stored;
+		recordCount++;
+	}
+	parseTime += getseconds() - time;
+	ImportStats *stats = options ? options->stats : null;
+	if (stats) {
+		stats->bytesRead = reader->file ? ftell(reader->file) : reader->cursor - mappedFile->data;
+		stats->linesParsed = reader->line;
+		stats->recordsBuilt = recordCount;
+		stats->numThreads = 1;
+		stats->parseTime = parseTime;
+		stats->normalizeTime = normalizeTime;
+		stats->storeTime = storeTime;
+	}
+	if (debugging) {
+		printf("Read %d records.\n", recordCount);
+		if (database->valuePool) showInternPoolStats(database->valuePool);
+	}
+	deleteGedcomReader(reader);
+	return database;
+}
+
+//  streamFromFile -- Read the records in a Gedcom file one at a time, normalize them, and pass
+//    them to a visitor function without building a database. Each tree is freed when the visitor
+//    returns, so the memory used is bounded by the largest record rather than by the file. The
+//    file is read with stdio rather than mapped, because a mapping grows as it is read. Returns
+//    the number of records visited, or -1 if the file can't be opened.
+//--------------------------------------------------------------------------------------------------
+int streamFromFile(String fileName, RecordVisitor visit, Word context, ErrorLog *errorLog)
+//  fileName -- Name of the Gedcom file to read.
+//  visit -- Function to call on each record, including the header and trailer.
+//  context -- Passed to the visitor as its last argument.
+//  errorLog -- Error log.
+{
+	ASSERT(fileName && visit);
+	GedcomReader *reader = createGedcomReader(fileName);
+	if (!reader) {
+		addErrorToLog(errorLog, createError(systemError, fileName, 0, "Could not open file."));
+		return -1;
+	}
+	int recordCount = 0;
+	int lineNo;
+	GNode *root;
+	while ((root = readNodeTree(reader, &lineNo, errorLog))) {
+		recordCount++;
+		root = normalizeNodeTree(root);
+		bool more = visit(root, lineNo, context);
+		freeGNodes(root);
+		if (!more) break;
+	}
+	deleteGedcomReader(reader);
+	return recordCount;
+}
+
+//  ConcurrentImport -- A file imported by importFromFilesConcurrently, with its own error log.
+//--------------------------------------------------------------------------------------------------
+typedef struct ConcurrentImport {
+	String fileName;         // Name of the file to import.
+	ImportOptions *options;  // Options shared by all the imports.
+	ErrorLog *errorLog;      // Errors found in this file.
+	Database *database;      // Database built from the file.
+	pthread_t thread;        // Thread that imports the file.
+} ConcurrentImport;
+
+//  importOneFile -- Thread function that imports one file of a concurrent import.
+//--------------------------------------------------------------------------------------------------
+static void *importOneFile(void *arg)
+{
+	ConcurrentImport *import = (ConcurrentImport*) arg;
+	import->database = importFromFileWithOptions(import->fileName, import->options, import->errorLog);
+	return null;
+}
+
+//  importFromFilesConcurrently -- Import Gedcom files into a list of Databases, importing each file
+//    on its own thread. The list and the error log are in the same order as the file names, the
+//    same as if importFromFiles had been used.
+//--------------------------------------------------------------------------------------------------
+List *importFromFilesConcurrently(String fileNames[], int count, ImportOptions *options,
+								  ErrorLog *errorLog)
+//  filesNames -- Names of the files to import.
+//  count -- Number of files to import.
+//  options -- Import options used for every file; null for the defaults.
+//  errorLog -- Error log.
+{
+	List *listOfDatabases = createList(null, null, null);
+	if (count <= 0) return listOfDatabases;
+	ConcurrentImport *imports = (ConcurrentImport*) stdalloc(count*sizeof(ConcurrentImport));
+	for (int i = 0; i < count; i++) {
+		imports[i].fileName = fileNames[i];
+		imports[i].options = options;
+		imports[i].errorLog = createList(null, null, null);
+		imports[i].database = null;
+		if (pthread_create(&imports[i].thread, null, importOneFile, imports + i)) FATAL();
+	}
+	for (int i = 0; i < count; i++) {
+		pthread_join(imports[i].thread, null);
+		if (imports[i].database) appendListElement(listOfDatabases, imports[i].database);
+		FORLIST(imports[i].errorLog, error)
+			addErrorToLog(errorLog, error);
+		ENDLIST
+		deleteList(imports[i].errorLog);
+	}
+	stdfree(imports);
+	return listOfDatabases;
+}
+
+//  Parallel import. The mapped file is split into chunks that start on level 0 lines, so every
+//    chunk holds whole records. Each chunk is read and normalized by its own thread with its own
+//    GedcomReader. The records are then stored in the database in file order by the calling
+//    thread. A sequential import stops at the first bad record, so the records in the chunks
+//    after the first one that stops early are dropped, and the database is the same as one built
+//    by a sequential import.
+//--------------------------------------------------------------------------------------------------
+#define MINCHUNKSIZE (1 << 20)  // Smallest chunk worth giving a thread.
+
+//  ImportedRecord -- A record read by an import thread, with the line it started on.
+//--------------------------------------------------------------------------------------------------
+typedef struct ImportedRecord {
+	GNode *root;     // Root of the normalized record.
+	int lineNumber;  // Line in the chunk where the record begins.
+} ImportedRecord;
+
+//  ImportChunk -- A part of a mapped Gedcom file and the records one thread read from it.
+//--------------------------------------------------------------------------------------------------
+typedef struct ImportChunk {
+	String start;      // Start of the chunk; the start of a level 0 line.
+	String end;        // End of the chunk; the start of a level 0 line or the end of the file.
+	String fileName;   // Name of the file, for error messages.
+	ImportedRecord *records;  // Records read from the chunk.
+	int count;         // Number of records read.
+	int maxCount;      // Number of records there is room for.
+	int lineCount;     // Number of lines in the chunk.
+	double parseTime;  // Time spent reading lines and building trees.
+	double normalizeTime;  // Time spent normalizing records.
+	bool stopped;      // Whether reading stopped before the end of the chunk.
+	Arena *arena;      // Arena the chunk's nodes are allocated from, if any.
+	InternPool *pool;  // Pool the chunk's values are interned in, if any; needs copyStrings.
+	bool copyStrings;  // Whether the nodes get copies of their strings instead of pointing in.
+	bool foldContinuations;  // Whether CONC and CONT lines are joined into values.
+	bool skipBadRecords;  // Whether a record with an error is skipped instead of stopping.
+	List *errors;      // Errors found in the chunk; line numbers are relative to the chunk.
+	pthread_t thread;  // Thread that reads the chunk.
+} ImportChunk;
+
+//  nextRecordStart -- Return the start of the first level 0 line at or after a line start, or
+//    the end of the memory if there isn't one.
+//--------------------------------------------------------------------------------------------------
+static String nextRecordStart(String p, String end)
+//  p -- Start of a line.
+//  end -- End of the memory.
+{
+	while (p < end) {
+		String q = p;
+		while (q < end && (*q == ' ' || *q == '\t')) q++;
+		if (q < end && *q == '0' && (q + 1 == end || iswhite(q[1]))) return p;
+		String newline = memchr(p, '\n', end - p);
+		if (!newline) return end;
+		p = newline + 1;
+	}
+	return end;
+}
+
+//  splitIntoChunks -- Split a mapped file into record aligned chunks of about the same size.
+//    Returns the number of chunks.
+//--------------------------------------------------------------------------------------------------
+static int splitIntoChunks(MappedFile *file, ImportChunk *chunks, int maxChunks, String fileName)
+{
+	String data = file->data, end = data + file->size;
+	int numChunks = 0;
+	String start = data;
+	for (int i = 1; i <= maxChunks && start < end; i++) {
+		String stop = end;
+		if (i < maxChunks) {
+			String target = data + (file->size / maxChunks) * i;
+			if (target < start) target = start;
+			String newline = memchr(target, '\n', end - target);
+			stop = newline ? nextRecordStart(newline + 1, end) : end;
+		}
+		if (stop == start) continue;
+		ImportChunk *chunk = chunks + numChunks++;
+		memset(chunk, 0, sizeof(ImportChunk));
+		chunk->start = start;
+		chunk->end = stop;
+		chunk->fileName = fileName;
+		chunk->errors = createList(null, null, null);
+		start = stop;
+	}
+	return numChunks;
+}
+
+//  importChunk -- Thread function that reads and normalizes the records in a chunk.
+//--------------------------------------------------------------------------------------------------
+static void *importChunk(void *arg)
+{
+	ImportChunk *chunk = (ImportChunk*) arg;
+	GedcomReader reader;
+	initMemoryReader(&reader, chunk->start, chunk->end, chunk->fileName);
+	reader.arena = chunk->arena;
+	reader.pool = chunk->pool;
+	reader.copyStrings = chunk->copyStrings;
+	reader.foldContinuations = chunk->foldContinuations;
+	reader.skipBadRecords = chunk->skipBadRecords;
+	chunk->maxCount = 1024;
+	chunk->records = (ImportedRecord*) stdalloc(chunk->maxCount*sizeof(ImportedRecord));
+	int lineNo;
+	GNode *root;
+	double time = getseconds();
+	while ((root = readNodeTree(&reader, &lineNo, chunk->errors))) {
+		double parsed = getseconds();
+		chunk->parseTime += parsed - time;
+		if (chunk->count >= chunk->maxCount) {
+			ImportedRecord *records = (ImportedRecord*) stdalloc(2*chunk->maxCount*sizeof(ImportedRecord));
+			memcpy(records, chunk->records, chunk->count*sizeof(ImportedRecord));
+			stdfree(chunk->records);
+			chunk->records = records;
+			chunk->maxCount *= 2;
+		}
+		chunk->records[chunk->count].root = normalizeNodeTree(root);
+		chunk->records[chunk->count++].lineNumber = lineNo;
+		time = getseconds();
+		chunk->normalizeTime += time - parsed;
+	}
+	chunk->parseTime += getseconds() - time;
+	chunk->lineCount = reader.line;
+	chunk->stopped = !reader.ateof;
+	return null;
+}
+
+//  storeChunk -- Store the records of a chunk in the database in file order and move its errors
+//    to the error log. If an earlier chunk stopped early the records and errors are dropped
+//    instead. The chunk's record array and error list are freed.
+//--------------------------------------------------------------------------------------------------
+static void storeChunk(Database *database, ImportChunk *chunk, int firstLine, bool stopped,
+					   ErrorLog *errorLog)
+//  database -- Database to store the records in.
+//  chunk -- Chunk whose records are stored.
+//  firstLine -- Number of lines in the file before the chunk.
+//  stopped -- Whether an earlier chunk stopped early.
+//  errorLog -- Error log.
+{
+	for (int j = 0; j < chunk->count; j++) {
+		GNode *root = chunk->records[j].root;
+		if (!stopped) storeRecord(database, root, firstLine + chunk->records[j].lineNumber);
+		else if (chunk->arena) ;
+		else if (chunk->pool) freeInternedGNodes(root);
+		else if (chunk->copyStrings) freeGNodes(root);
+		else freeGNodesInPlace(root);
+	}
+	FORLIST(chunk->errors, element)
+		Error *error = (Error*) element;
+		if (stopped) deleteError(error);
+		else {
+			error->lineNumber += firstLine;
+			addErrorToLog(errorLog, error);
+		}
+	ENDLIST
+	deleteList(chunk->errors);
+	stdfree(chunk->records);
+}
+
+//  importInParallel -- Import the records in a Gedcom file into a Database using threads to read
+//    and normalize them. The file is mapped, and the database keeps the mapping.
+//--------------------------------------------------------------------------------------------------
+static Database *importInParallel(String fileName, ImportOptions *options, ErrorLog *errorLog)
+//  fileName -- Name of the Gedcom file.
+//  options -- Import options; numThreads is the maximum number of threads to use.
+//  errorLog -- Error log.
+{
+	int numThreads = options->numThreads;
+	MappedFile *mappedFile = createMappedFile(fileName);
+	if (!mappedFile) {
+		addErrorToLog(errorLog, createError(systemError, fileName, 0, "Could not open file."));
+		return null;
+	}
+	//  Don't give threads less than a minimum amount of the file to read.
+	int maxChunks = (int) (mappedFile->size / MINCHUNKSIZE) + 1;
+	if (maxChunks > numThreads) maxChunks = numThreads;
+	ImportChunk *chunks = (ImportChunk*) stdalloc(maxChunks*sizeof(ImportChunk));
+	int numChunks = splitIntoChunks(mappedFile, chunks, maxChunks, fileName);
+	if (numChunks == 0) {
+		stdfree(chunks);
+		deleteMappedFile(mappedFile);
+		addErrorToLog(errorLog, createError(systemError, fileName, 0, "the file is empty"));
+		return null;
+	}
+
+	//  Each thread has its own arena; they are merged into the database's arena afterwards.
+	if (options->useArena)
+		for (int i = 0; i < numChunks; i++) chunks[i].arena = createArena(0);
+	for (int i = 0; i < numChunks; i++) {
+		chunks[i].foldContinuations = options->foldContinuations;
+		chunks[i].skipBadRecords = options->skipBadRecords;
 	}
-	if (debugging) printf("Read %d records.\n", recordCount);
 
+	//  The prescan must be done before the threads change the mapping.
+	Database *database = createDatabase(fileName);
+	if (options->prescan) presizeDatabase(database, fileName, mappedFile, options->stats);
+
+	//  Read the chunks. The calling thread reads the first one.
+	for (int i = 1; i < numChunks; i++)
+		if (pthread_create(&chunks[i].thread, null, importChunk, chunks + i)) FATAL();
+	importChunk(chunks);
+	for (int i = 1; i < numChunks; i++) pthread_join(chunks[i].thread, null);
+
+	//  Store the records in file order and move the errors to the error log.
+	database->mappedFile = mappedFile;
+	if (options->useArena) database->arena = createArena(0);
+	int recordCount = 0;
+	int firstLine = 0;  // Number of lines in the chunks before this one.
+	bool stopped = false;  // Whether an earlier chunk stopped early.
+	double parseTime = 0, normalizeTime = 0, storeStart = getseconds();
+	for (int i = 0; i < numChunks; i++) {
+		ImportChunk *chunk = chunks + i;
+		storeChunk(database, chunk, firstLine, stopped, errorLog);
+		if (!stopped) recordCount += chunk->count;
+		stopped = stopped || chunk->stopped;
+		firstLine += chunk->lineCount;
+		parseTime += chunk->parseTime;
+		normalizeTime += chunk->normalizeTime;
+		if (chunk->arena) mergeArena(database->arena, chunk->arena);
+	}
+	stdfree(chunks);
+	if (options->stats) {
+		ImportStats *stats = options->stats;
+		stats->bytesRead = mappedFile->size;
+		stats->linesParsed = firstLine;
+		stats->recordsBuilt = recordCount;
+		stats->numThreads = numChunks;
+		stats->parseTime = parseTime;
+		stats->normalizeTime = normalizeTime;
+		stats->storeTime = getseconds() - storeStart;
+	}
+	if (debugging) printf("Read %d records with %d threads.\n", recordCount, numChunks);
 	return database;
 }
 
+//  Pipelined import. Reading the file, building the records, and storing them run at the same
+//    time on three threads, so the time spent waiting for the disk overlaps the time spent on
+//    the records. A read ahead thread fills a ring of large buffers, cutting each at the start of
+//    a level 0 line so it holds whole records. A parse thread reads and normalizes the records of
+//    each buffer as an ImportChunk and returns the buffer to the ring. The calling thread stores
+//    the chunks in file order. The queues between the threads are bounded, so a slow stage makes
+//    the stages before it wait rather than use more memory. A gzipped file is decompressed by the
+//    read ahead thread as it fills the buffers, so decompressing overlaps parsing and no
+//    uncompressed copy of the file is written.
+//--------------------------------------------------------------------------------------------------
+#define PIPEBUFFERSIZE (1 << 20)  // Size of the buffers the file is read into.
+#define NUMPIPEBUFFERS 4          // Number of buffers in the ring.
+#define NUMPIPECHUNKS 4           // Number of parsed chunks that can wait to be stored.
+
+//  PipeBuffer -- A buffer in the ring. It holds whole records, followed by a 0.
+//--------------------------------------------------------------------------------------------------
+typedef struct PipeBuffer {
+	String data;    // Text of the records.
+	size_t length;  // Number of characters of records.
+	size_t size;    // Room in data, not counting the 0.
+} PipeBuffer;
+
+//  Pipeline -- State shared by the threads of a pipelined import.
+//--------------------------------------------------------------------------------------------------
+typedef struct Pipeline {
+	FILE *file;                 // File being read, if it is not gzipped.
+	gzFile gzip;                // Gzipped file being read, if it is.
+	String fileName;            // Name of the file, for error messages.
+	PipeBuffer buffers[NUMPIPEBUFFERS];  // The ring of buffers.
+	BoundedQueue *freeBuffers;  // Buffers ready to be filled.
+	BoundedQueue *fullBuffers;  // Buffers ready to be parsed.
+	BoundedQueue *chunks;       // Chunks ready to be stored.
+	String carry;               // Start of a record cut off at the end of a buffer.
+	size_t carrySize;           // Room in carry.
+	Arena *arena;               // Arena the parse thread allocates nodes from, if any.
+	InternPool *pool;           // Pool the parse thread interns values in, if any.
+	bool foldContinuations;     // Whether the parse thread joins CONC and CONT lines into values.
+	bool skipBadRecords;        // Whether the parse thread skips records with errors.
+	size_t bytesRead;           // Bytes read from the file, after decompressing.
+	double readTime;            // Time spent reading the file.
+	bool readError;             // Whether reading the file failed.
+} Pipeline;
+
+//  growPipeBuffer -- Make a buffer larger, keeping its contents.
+//--------------------------------------------------------------------------------------------------
+static void growPipeBuffer(PipeBuffer *buffer, size_t size, size_t keep)
+//  buffer -- Buffer to grow.
+//  size -- New room in the buffer.
+//  keep -- Number of characters at the start of the buffer to keep.
+{
+	String data = (String) stdalloc(size + 1);
+	if (keep) memcpy(data, buffer->data, keep);
+	if (buffer->data) stdfree(buffer->data);
+	buffer->data = data;
+	buffer->size = size;
+}
+
+//  lastRecordStart -- Return the start of the last complete level 0 line in a buffer after its
+//    first character, or null if there isn't one.
+//--------------------------------------------------------------------------------------------------
+static String lastRecordStart(String data, size_t length)
+{
+	for (String p = data + length - 1; p > data; p--) {
+		if (p[-1] != '\n') continue;
+		String q = p;
+		while (q < data + length && (*q == ' ' || *q == '\t')) q++;
+		if (q + 1 < data + length && *q == '0' && iswhite(q[1])) return p;
+	}
+	return null;
+}
+
+//  readPipeFile -- Read up to count bytes from the file of a pipeline, decompressing them if the
+//    file is gzipped. Returns the number of bytes read; 0 at the end of the file or on an error.
+//--------------------------------------------------------------------------------------------------
+static size_t readPipeFile(Pipeline *pipe, String data, size_t count)
+{
+	if (!pipe->gzip) {
+		size_t read = fread(data, 1, count, pipe->file);
+		if (read == 0 && ferror(pipe->file)) pipe->readError = true;
+		return read;
+	}
+	if (count > INT_MAX) count = INT_MAX;
+	int read = gzread(pipe->gzip, data, (unsigned) count);
+	if (read <= 0) {
+		//  A truncated file ends without an error from gzread, but gzerror reports it.
+		int code;
+		gzerror(pipe->gzip, &code);
+		if (read < 0 || code != Z_OK) pipe->readError = true;
+	}
+	return read < 0 ? 0 : read;
+}
+
+//  readAhead -- Thread function that fills the buffers of a pipeline with whole records. The
+//    text after the last level 0 line read into a buffer is carried to the next one; if a buffer
+//    holds no level 0 line after its first, the record is too big for it, and it is made larger.
+//    Stops at the end of the file or when the free buffer queue is closed.
+//--------------------------------------------------------------------------------------------------
+static void *readAhead(void *arg)
+{
+	Pipeline *pipe = (Pipeline*) arg;
+	size_t carried = 0;  // Length of the text in carry.
+	bool first = true;
+	PipeBuffer *buffer;
+	while ((buffer = (PipeBuffer*) takeBoundedQueue(pipe->freeBuffers))) {
+		if (buffer->size < carried + PIPEBUFFERSIZE) growPipeBuffer(buffer, carried + PIPEBUFFERSIZE, 0);
+		if (carried) memcpy(buffer->data, pipe->carry, carried);
+		size_t length = carried;
+		String cut = null;
+		double time = getseconds();
+		while (true) {
+			size_t count = readPipeFile(pipe, buffer->data + length, buffer->size - length);
+			length += count;
+			pipe->bytesRead += count;
+			if (count == 0) break;
+			if ((cut = lastRecordStart(buffer->data, length))) break;
+			if (length == buffer->size) growPipeBuffer(buffer, 2*buffer->size, length);
+		}
+		pipe->readTime += getseconds() - time;
+		if (!cut) {
+			//  At the end of the file the buffer holds the rest of the records.
+			buffer->length = length;
+			buffer->data[length] = 0;
+			if (length > 0 || first) putBoundedQueue(pipe->fullBuffers, buffer);
+			break;
+		}
+		carried = buffer->data + length - cut;
+		if (pipe->carrySize < carried) {
+			if (pipe->carry) stdfree(pipe->carry);
+			pipe->carry = (String) stdalloc(pipe->carrySize = 2*carried);
+		}
+		memcpy(pipe->carry, cut, carried);
+		buffer->length = cut - buffer->data;
+		buffer->data[buffer->length] = 0;
+		putBoundedQueue(pipe->fullBuffers, buffer);
+		first = false;
+	}
+	closeBoundedQueue(pipe->fullBuffers);
+	return null;
+}
+
+//  parseBuffers -- Thread function that reads and normalizes the records in the buffers of a
+//    pipeline. The nodes get copies of their strings so the buffers can be reused. When a chunk
+//    stops early the free buffer queue is closed, which stops the read ahead thread, and the
+//    buffers still coming are skipped.
+//--------------------------------------------------------------------------------------------------
+static void *parseBuffers(void *arg)
+{
+	Pipeline *pipe = (Pipeline*) arg;
+	bool stopped = false;
+	PipeBuffer *buffer;
+	while ((buffer = (PipeBuffer*) takeBoundedQueue(pipe->fullBuffers))) {
+		if (!stopped) {
+			ImportChunk *chunk = (ImportChunk*) stdalloc(sizeof(ImportChunk));
+			memset(chunk, 0, sizeof(ImportChunk));
+			chunk->start = buffer->data;
+			chunk->end = buffer->data + buffer->length;
+			chunk->fileName = pipe->fileName;
+			chunk->errors = createList(null, null, null);
+			chunk->arena = pipe->arena;
+			chunk->pool = pipe->pool;
+			chunk->copyStrings = true;
+			chunk->foldContinuations = pipe->foldContinuations;
+			chunk->skipBadRecords = pipe->skipBadRecords;
+			importChunk(chunk);
+			if ((stopped = chunk->stopped)) closeBoundedQueue(pipe->freeBuffers);
+			putBoundedQueue(pipe->chunks, chunk);
+		}
+		putBoundedQueue(pipe->freeBuffers, buffer);  // Does nothing once the queue is closed.
+	}
+	closeBoundedQueue(pipe->chunks);
+	return null;
+}
+
+//  importPipelined -- Import the records in a Gedcom file into a Database, reading the file and
+//    building the records on their own threads while this thread stores them. The file may be
+//    gzipped.
+//--------------------------------------------------------------------------------------------------
+static Database *importPipelined(String fileName, ImportOptions *options, ErrorLog *errorLog)
+//  fileName -- Name of the Gedcom file.
+//  options -- Import options; null for the defaults.
+//  errorLog -- Error log.
+{
+	ImportOptions defaults;
+	if (!options) {
+		memset(&defaults, 0, sizeof(ImportOptions));
+		options = &defaults;
+	}
+	Pipeline pipe;
+	memset(&pipe, 0, sizeof(Pipeline));
+	bool gzipped = isGzipFile(fileName);
+	if (gzipped) {
+		if ((pipe.gzip = gzopen(fileName, "rb"))) gzbuffer(pipe.gzip, PIPEBUFFERSIZE/4);
+	} else
+		pipe.file = fopen(fileName, "r");
+	if (!pipe.file && !pipe.gzip) {
+		addErrorToLog(errorLog, createError(systemError, fileName, 0, "Could not open file."));
+		return null;
+	}
+	pipe.fileName = fileName;
+	pipe.freeBuffers = createBoundedQueue(NUMPIPEBUFFERS);
+	pipe.fullBuffers = createBoundedQueue(NUMPIPEBUFFERS);
+	pipe.chunks = createBoundedQueue(NUMPIPECHUNKS);
+	for (int i = 0; i < NUMPIPEBUFFERS; i++) putBoundedQueue(pipe.freeBuffers, pipe.buffers + i);
+
+	//  Only the parse thread allocates from the arena and the pool; the database gets them after.
+	Database *database = createDatabase(fileName);
+	if (options->useArena) pipe.arena = database->arena = createArena(0);
+	if (options->internValues) pipe.pool = database->valuePool = createInternPool();
+	pipe.foldContinuations = options->foldContinuations;
+	pipe.skipBadRecords = options->skipBadRecords;
+	if (options->prescan && !gzipped) presizeDatabase(database, fileName, null, options->stats);
+
+	pthread_t reading, parsing;
+	if (pthread_create(&reading, null, readAhead, &pipe)) FATAL();
+	if (pthread_create(&parsing, null, parseBuffers, &pipe)) FATAL();
+
+	//  Store the chunks as they come.
+	int recordCount = 0, firstLine = 0;
+	double parseTime = 0, normalizeTime = 0, storeTime = 0;
+	ImportChunk *chunk;
+	while ((chunk = (ImportChunk*) takeBoundedQueue(pipe.chunks))) {
+		double time = getseconds();
+		storeChunk(database, chunk, firstLine, false, errorLog);
+		storeTime += getseconds() - time;
+		recordCount += chunk->count;
+		firstLine += chunk->lineCount;
+		parseTime += chunk->parseTime;
+		normalizeTime += chunk->normalizeTime;
+		stdfree(chunk);
+	}
+	pthread_join(parsing, null);
+	pthread_join(reading, null);
+	if (pipe.readError)
+		addErrorToLog(errorLog, createError(systemError, fileName, firstLine, "Could not read file."));
+
+	for (int i = 0; i < NUMPIPEBUFFERS; i++)
+		if (pipe.buffers[i].data) stdfree(pipe.buffers[i].data);
+	if (pipe.carry) stdfree(pipe.carry);
+	deleteBoundedQueue(pipe.freeBuffers);
+	deleteBoundedQueue(pipe.fullBuffers);
+	deleteBoundedQueue(pipe.chunks);
+	if (pipe.gzip) gzclose(pipe.gzip);
+	else fclose(pipe.file);
+	if (options->stats) {
+		ImportStats *stats = options->stats;
+		stats->bytesRead = pipe.bytesRead;
+		stats->linesParsed = firstLine;
+		stats->recordsBuilt = recordCount;
+		stats->numThreads = 1;
+		stats->readTime = pipe.readTime;
+		stats->parseTime = parseTime;
+		stats->normalizeTime = normalizeTime;
+		stats->storeTime = storeTime;
+	}
+	if (debugging) {
+		printf("Read %d records with a pipeline%s.\n", recordCount, gzipped ? " from a gzipped file" : "");
+		if (database->valuePool) showInternPoolStats(database->valuePool);
+	}
+	return database;
+}
+
+//  levelZeroIndex -- If a line is a level 0 line, return the index its record belongs in and set
+//    the record's key. Returns null for other lines, for HEAD and TRLR records, and for records
+//    without keys. The key is copied to the database's arena; the line is not changed.
+//--------------------------------------------------------------------------------------------------
+static RecordIndex *levelZeroIndex(String p, String end, Database *database, String *key,
+								   bool *isLevelZero)
+//  p -- Start of the line.
+//  end -- Start of the next line.
+//  database -- Database whose index is returned.
+//  key -- (out) Key of the record.
+//  isLevelZero -- (out) Whether the line is a level 0 line.
+{
+	*isLevelZero = false;
+	while (p < end && iswhite(*p)) p++;
+	if (p + 1 >= end || p[0] != '0' || !iswhite(p[1])) return null;
+	*isLevelZero = true;
+	p++;
+	while (p < end && iswhite(*p)) p++;
+	if (p >= end || *p != '@') return null;
+	String keyStart = p++;
+	while (p < end && *p != '@' && *p != '\n') p++;
+	if (p >= end || *p != '@') return null;
+	size_t keyLength = ++p - keyStart;
+	while (p < end && iswhite(*p)) p++;
+	char tag[32];
+	int tagLength = 0;
+	while (p < end && !iswhite(*p) && *p != '\r' && *p != '\n' && tagLength < sizeof(tag) - 1)
+		tag[tagLength++] = *p++;
+	tag[tagLength] = 0;
+	RecordIndex *index = null;
+	switch (tagToRecordType(tag)) {
+		case GRPerson: index = database->personIndex; break;
+		case GRFamily: index = database->familyIndex; break;
+		case GRSource: index = database->sourceIndex; break;
+		case GREvent: index = database->eventIndex; break;
+		case GROther: index = database->otherIndex; break;
+		default: return null;
+	}
+	*key = (String) arenaAlloc(database->arena, keyLength + 1);
+	memcpy(*key, keyStart, keyLength);
+	(*key)[keyLength] = 0;
+	return index;
+}
+
+//  addUnreadRecord -- Add a record that has not been read to an index of a lazy database, and
+//    give it a record id.
+//--------------------------------------------------------------------------------------------------
+static void addUnreadRecord(Database *database, RecordIndex *index, String key, String start,
+							String end, int lineNumber)
+{
+	RecordIndexEl *element = insertUnreadInRecordIndex(index, key, start, end, lineNumber);
+	if (element) assignRecordId(database, element);
+}
+
+//  importLazily -- Build a database whose records are read when they are first needed. The file
+//    is mapped, and one pass over it finds the level 0 lines; each record is put in its index with
+//    its key, line number, and the location of its text. Errors in a record are not found until
+//    the record is read; they are added to the database's lazy error log. No trees are built, so
+//    the stats only have the size of the file and the time of the pass, which counts as parsing.
+//--------------------------------------------------------------------------------------------------
+static Database *importLazily(String fileName, ImportStats *stats, ErrorLog *errorLog)
+//  fileName -- Name of the Gedcom file.
+//  stats -- Import stats to fill in; can be null.
+//  errorLog -- Error log.
+{
+	double startTime = getseconds();
+	MappedFile *mappedFile = createMappedFile(fileName);
+	if (!mappedFile) {
+		addErrorToLog(errorLog, createError(systemError, fileName, 0, "Could not open file."));
+		return null;
+	}
+	Database *database = createDatabase(fileName);
+	database->mappedFile = mappedFile;
+	database->arena = createArena(0);
+	database->lazyErrorLog = createErrorLog();
+
+	String p = mappedFile->data, end = p + mappedFile->size;
+	RecordIndex *index = null;  // Index of the record being scanned, if it is kept.
+	String key = null, start = null;
+	int lineNumber = 0, startLine = 0, recordCount = 0;
+	while (p < end) {
+		lineNumber++;
+		String newline = memchr(p, '\n', end - p);
+		String next = newline ? newline + 1 : end;
+		bool isLevelZero;
+		String nextKey;
+		RecordIndex *nextIndex = levelZeroIndex(p, next, database, &nextKey, &isLevelZero);
+		if (isLevelZero) {
+			if (index) addUnreadRecord(database, index, key, start, p, startLine);
+			index = nextIndex;
+			key = nextKey;
+			start = p;
+			startLine = lineNumber;
+			recordCount++;
+		}
+		p = next;
+	}
+	if (index) addUnreadRecord(database, index, key, start, end, startLine);
+	if (stats) {
+		stats->bytesRead = mappedFile->size;
+		stats->linesParsed = lineNumber;
+		stats->numThreads = 1;
+		stats->parseTime = getseconds() - startTime;
+	}
+	if (debugging) printf("Found %d records.\n", recordCount);
+	return database;
+}
+
+//  readUnreadRecord -- Read and normalize a record of a lazy database. The record is read from
+//    the mapped file into the database's arena. It is not read again, even if it had errors.
+//    Returns null if the record had errors. A bad line without a level is kept in the text of the
+//    record before it; as in an eager import, that record is kept up to the line, and the line's
+//    error is logged.
+//--------------------------------------------------------------------------------------------------
+GNode *readUnreadRecord(RecordIndexEl *element, Database *database)
+{
+	ASSERT(element && element->start && database);
+	GedcomReader reader;
+	initMemoryReader(&reader, element->start, element->end, database->fileName);
+	reader.arena = database->arena;
+	reader.line = element->lineNumber - 1;
+	reader.foldContinuations = database->foldedValues;
+	int lineNumber;
+	GNode *root = readNodeTree(&reader, &lineNumber, database->lazyErrorLog);
+	element->start = element->end = null;
+	if (reader.pending) {  // A line that may start a record could not be read.
+		addErrorToLog(database->lazyErrorLog, reader.pending);
+		reader.pending = null;
+	}
+	return root ? normalizeNodeTree(root) : null;
+}
+
 String misnam = (String) "Missing NAME line in INDI record; record ignored.\n";
 String noiref = (String) "FAM record has no INDI references; record ignored.\n";
 
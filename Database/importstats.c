@@ -0,0 +1,77 @@
+//
+//  DeadEnds
+//
+//  importstats.c -- Functions that report the measurements made while importing a Gedcom file.
+//    Each phase is reported with its time and its rate, so load regressions can be tracked.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#include "importstats.h"
+
+//  rate -- Return a count per second, or 0 if no time was measured.
+//--------------------------------------------------------------------------------------------------
+static double rate(double count, double seconds)
+{
+	return seconds > 0 ? count / seconds : 0;
+}
+
+//  showImportStats -- Write import stats as text, one phase per line.
+//--------------------------------------------------------------------------------------------------
+void showImportStats(ImportStats *stats, FILE *file)
+{
+	ASSERT(stats && file);
+	fprintf(file, "Import: %zu bytes, %d lines, %d records, %d errors, %d threads, %.3fs, %.1f MB/s\n",
+			stats->bytesRead, stats->linesParsed, stats->recordsBuilt, stats->numErrors,
+			stats->numThreads, stats->totalTime, rate(stats->bytesRead / 1e6, stats->totalTime));
+	if (stats->prescanTime > 0)
+		fprintf(file, "  prescan:    %.3fs, %.1f MB/s\n", stats->prescanTime,
+				rate(stats->bytesRead / 1e6, stats->prescanTime));
+	if (stats->readTime > 0)
+		fprintf(file, "  read:       %.3fs, %.1f MB/s\n", stats->readTime,
+				rate(stats->bytesRead / 1e6, stats->readTime));
+	fprintf(file, "  parse:      %.3fs, %.1f MB/s, %.0f lines/s\n", stats->parseTime,
+			rate(stats->bytesRead / 1e6, stats->parseTime), rate(stats->linesParsed, stats->parseTime));
+	fprintf(file, "  normalize:  %.3fs, %.0f records/s\n", stats->normalizeTime,
+			rate(stats->recordsBuilt, stats->normalizeTime));
+	fprintf(file, "  store:      %.3fs, %.0f records/s\n", stats->storeTime,
+			rate(stats->recordsBuilt, stats->storeTime));
+	if (stats->linksResolved > 0)
+		fprintf(file, "  resolve:    %.3fs, %d links, %.0f links/s\n", stats->resolveLinksTime,
+				stats->linksResolved, rate(stats->linksResolved, stats->resolveLinksTime));
+	fprintf(file, "  indexNames: %.3fs, %d names, %.0f names/s\n", stats->indexNamesTime,
+			stats->namesIndexed, rate(stats->namesIndexed, stats->indexNamesTime));
+	fprintf(file, "  validate:   %.3fs, %.0f records/s\n", stats->validateTime,
+			rate(stats->recordsBuilt, stats->validateTime));
+}
+
+//  writeImportStatsJSON -- Write import stats as a JSON object on one line.
+//--------------------------------------------------------------------------------------------------
+void writeImportStatsJSON(ImportStats *stats, FILE *file)
+{
+	ASSERT(stats && file);
+	fprintf(file, "{\"bytesRead\":%zu,\"linesParsed\":%d,\"recordsBuilt\":%d,\"namesIndexed\":%d,"
+			"\"numErrors\":%d,\"numThreads\":%d,\"totalTime\":%.6f,\"bytesPerSecond\":%.0f,",
+			stats->bytesRead, stats->linesParsed, stats->recordsBuilt, stats->namesIndexed,
+			stats->numErrors, stats->numThreads, stats->totalTime,
+			rate(stats->bytesRead, stats->totalTime));
+	fprintf(file, "\"prescan\":{\"time\":%.6f,\"bytesPerSecond\":%.0f},", stats->prescanTime,
+			rate(stats->bytesRead, stats->prescanTime));
+	fprintf(file, "\"read\":{\"time\":%.6f,\"bytesPerSecond\":%.0f},", stats->readTime,
+			rate(stats->bytesRead, stats->readTime));
+	fprintf(file, "\"parse\":{\"time\":%.6f,\"bytesPerSecond\":%.0f,\"linesPerSecond\":%.0f},",
+			stats->parseTime, rate(stats->bytesRead, stats->parseTime),
+			rate(stats->linesParsed, stats->parseTime));
+	fprintf(file, "\"normalize\":{\"time\":%.6f,\"recordsPerSecond\":%.0f},", stats->normalizeTime,
+			rate(stats->recordsBuilt, stats->normalizeTime));
+	fprintf(file, "\"store\":{\"time\":%.6f,\"recordsPerSecond\":%.0f},", stats->storeTime,
+			rate(stats->recordsBuilt, stats->storeTime));
+	fprintf(file, "\"resolveLinks\":{\"time\":%.6f,\"links\":%d,\"linksPerSecond\":%.0f},",
+			stats->resolveLinksTime, stats->linksResolved,
+			rate(stats->linksResolved, stats->resolveLinksTime));
+	fprintf(file, "\"indexNames\":{\"time\":%.6f,\"namesPerSecond\":%.0f},", stats->indexNamesTime,
+			rate(stats->namesIndexed, stats->indexNamesTime));
+	fprintf(file, "\"validate\":{\"time\":%.6f,\"recordsPerSecond\":%.0f}}\n", stats->validateTime,
+			rate(stats->recordsBuilt, stats->validateTime));
+}
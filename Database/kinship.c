@@ -0,0 +1,285 @@
+//
+//  DeadEnds
+//
+//  kinship.c -- Implements the KinshipGraph type. The persons and families of a database are given
+//    dense ids, and the relationships between them are kept in arrays of ids, so programs that
+//    walk pedigrees or find relationships follow array indexes instead of looking up keys.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#include "kinship.h"
+#include "recordindex.h"
+#include "gedcom.h"
+#include "sort.h"
+
+static bool debugging = false;
+
+//  KinshipId -- Element of the tables that map keys to dense ids.
+//--------------------------------------------------------------------------------------------------
+typedef struct KinshipId {
+	String key;  // Key of the record; not owned by the element.
+	int id;      // Dense id of the record.
+} KinshipId;
+
+static String kinshipIdKey(Word element) { return ((KinshipId*) element)->key; }
+static void deleteKinshipId(Word element) { stdfree(element); }
+
+//  compareLineNumbers -- Compare two record index elements by the lines their records start on.
+//--------------------------------------------------------------------------------------------------
+static int compareLineNumbers(Word a, Word b)
+{
+	return ((RecordIndexEl*) a)->lineNumber - ((RecordIndexEl*) b)->lineNumber;
+}
+
+//  numberRecords -- Put the elements of a record index in an array in file order, and make a
+//    table that maps their keys to their indexes in the array. Returns the array.
+//--------------------------------------------------------------------------------------------------
+static RecordIndexEl **numberRecords(RecordIndex *index, int *count, HashTable **ids)
+//  index -- Record index to number.
+//  count -- (out) Number of records.
+//  ids -- (out) Table of the ids of the records by key.
+{
+	int numRecords = sizeHashTable(index);
+	RecordIndexEl **records = (RecordIndexEl**) stdalloc((numRecords + 1)*sizeof(RecordIndexEl*));
+	int i = 0;
+	FORHASHTABLE(index, element)
+		records[i++] = (RecordIndexEl*) element;
+	ENDHASHTABLE
+	if (numRecords > 1) {
+		ldata = (Word*) records;
+		lcmp = compareLineNumbers;
+		quickSort(0, numRecords - 1);
+	}
+	*ids = createHashTable(null, deleteKinshipId, kinshipIdKey);
+	reserveHashTable(*ids, numRecords);
+	for (i = 0; i < numRecords; i++) {
+		KinshipId *element = (KinshipId*) stdalloc(sizeof(KinshipId));
+		element->key = records[i]->key;
+		element->id = i;
+		insertInHashTable(*ids, element);
+	}
+	*count = numRecords;
+	return records;
+}
+
+//  lookupId -- Return the dense id of a key in an id table, or -1 if it isn't there.
+//--------------------------------------------------------------------------------------------------
+static int lookupId(HashTable *ids, String key)
+{
+	if (!key) return -1;
+	KinshipId *element = searchHashTable(ids, key);
+	return element ? element->id : -1;
+}
+
+//  createEdges -- Allocate the offsets of a set of edges. The offsets are used to count the edges
+//    from each node until allocateTargets is called.
+//--------------------------------------------------------------------------------------------------
+static void createEdges(KinshipEdges *edges, int numNodes)
+{
+	edges->offsets = (int*) stdalloc((numNodes + 1)*sizeof(int));
+	memset(edges->offsets, 0, (numNodes + 1)*sizeof(int));
+	edges->targets = null;
+}
+
+//  allocateTargets -- Turn the counts of the edges from each node into offsets, and allocate the
+//    targets. Returns an array of cursors, one per node, for filling in the targets.
+//--------------------------------------------------------------------------------------------------
+static int *allocateTargets(KinshipEdges *edges, int numNodes)
+{
+	for (int i = 0; i < numNodes; i++) edges->offsets[i + 1] += edges->offsets[i];
+	edges->targets = (int*) stdalloc((edges->offsets[numNodes] + 1)*sizeof(int));
+	int *cursors = (int*) stdalloc((numNodes + 1)*sizeof(int));
+	memcpy(cursors, edges->offsets, (numNodes + 1)*sizeof(int));
+	return cursors;
+}
+
+//  addEdge -- Count an edge, or add it if the targets have been allocated.
+//--------------------------------------------------------------------------------------------------
+static void addEdge(KinshipEdges *edges, int *cursors, int from, int to)
+//  edges -- Edges to add to.
+//  cursors -- Cursors from allocateTargets; null when counting.
+//  from -- Id of the node the edge is from.
+//  to -- Id of the node the edge is to.
+{
+	if (cursors) edges->targets[cursors[from]++] = to;
+	else edges->offsets[from + 1]++;
+}
+
+//  Cursors -- The cursors of the person edges while they are being filled in.
+//--------------------------------------------------------------------------------------------------
+typedef struct Cursors {
+	int *parents, *children, *spouses, *childIn, *spouseIn;
+} Cursors;
+
+//  addFamilyEdges -- Count, or add, the person edges that come from one family.
+//--------------------------------------------------------------------------------------------------
+static void addFamilyEdges(KinshipGraph *graph, int family, Cursors *cursors)
+//  graph -- Graph being built.
+//  family -- Id of the family.
+//  cursors -- Cursors of the person edges; null when counting.
+{
+	int *members = graph->members.targets + graph->members.offsets[family];
+	int numMembers = graph->members.offsets[family + 1] - graph->members.offsets[family];
+	int numSpouses = graph->numSpouses[family];
+	bool fill = cursors != null;
+	for (int i = 0; i < numSpouses; i++) {
+		int spouse = members[i];
+		addEdge(&graph->spouseIn, fill ? cursors->spouseIn : null, spouse, family);
+		for (int j = 0; j < numSpouses; j++)
+			if (j != i) addEdge(&graph->spouses, fill ? cursors->spouses : null, spouse, members[j]);
+		for (int j = numSpouses; j < numMembers; j++)
+			addEdge(&graph->children, fill ? cursors->children : null, spouse, members[j]);
+	}
+	for (int i = numSpouses; i < numMembers; i++) {
+		int child = members[i];
+		addEdge(&graph->childIn, fill ? cursors->childIn : null, child, family);
+		for (int j = 0; j < numSpouses; j++)
+			addEdge(&graph->parents, fill ? cursors->parents : null, child, members[j]);
+	}
+}
+
+//  addMembers -- Count, or add, the members of a family: its HUSB and WIFE persons, then its
+//    CHIL persons. Links to persons not in the database are left out.
+//--------------------------------------------------------------------------------------------------
+static void addMembers(KinshipGraph *graph, int family, GNode *root, int *cursors)
+{
+	int numSpouses = 0;
+	for (int pass = 0; pass < 2; pass++) {
+		for (GNode *node = root->child; node; node = node->sibling) {
+			bool isSpouse = eqstr(node->tag, "HUSB") || eqstr(node->tag, "WIFE");
+			if (pass == 0 ? !isSpouse : !eqstr(node->tag, "CHIL")) continue;
+			int person = lookupId(graph->personIds, node->value);
+			if (person < 0) continue;
+			addEdge(&graph->members, cursors, family, person);
+			if (pass == 0) numSpouses++;
+		}
+	}
+	graph->numSpouses[family] = numSpouses;
+}
+
+//  createKinshipGraph -- Build the kinship graph of a database. Persons and families are numbered
+//    in the order they are in the Gedcom file. The edges come from the HUSB, WIFE and CHIL links
+//    of the families; the FAMC and FAMS links of the persons are not read.
+//--------------------------------------------------------------------------------------------------
+KinshipGraph *createKinshipGraph(Database *database)
+{
+	ASSERT(database);
+	KinshipGraph *graph = (KinshipGraph*) stdalloc(sizeof(KinshipGraph));
+	graph->database = database;
+	graph->persons = numberRecords(database->personIndex, &graph->numPersons, &graph->personIds);
+	graph->families = numberRecords(database->familyIndex, &graph->numFamilies, &graph->familyIds);
+	int numPersons = graph->numPersons, numFamilies = graph->numFamilies;
+
+	//  Find the members of the families.
+	graph->numSpouses = (int*) stdalloc((numFamilies + 1)*sizeof(int));
+	createEdges(&graph->members, numFamilies);
+	for (int f = 0; f < numFamilies; f++) {
+		GNode *root = elementToRecord(graph->families[f], database);
+		if (root) addMembers(graph, f, root, null);
+	}
+	int *cursors = allocateTargets(&graph->members, numFamilies);
+	for (int f = 0; f < numFamilies; f++) {
+		GNode *root = elementToRecord(graph->families[f], database);
+		if (root) addMembers(graph, f, root, cursors);
+	}
+	stdfree(cursors);
+
+	//  Count the person edges, then add them.
+	createEdges(&graph->parents, numPersons);
+	createEdges(&graph->children, numPersons);
+	createEdges(&graph->spouses, numPersons);
+	createEdges(&graph->childIn, numPersons);
+	createEdges(&graph->spouseIn, numPersons);
+	for (int f = 0; f < numFamilies; f++) addFamilyEdges(graph, f, null);
+	Cursors personCursors = {
+		allocateTargets(&graph->parents, numPersons),
+		allocateTargets(&graph->children, numPersons),
+		allocateTargets(&graph->spouses, numPersons),
+		allocateTargets(&graph->childIn, numPersons),
+		allocateTargets(&graph->spouseIn, numPersons)
+	};
+	for (int f = 0; f < numFamilies; f++) addFamilyEdges(graph, f, &personCursors);
+	stdfree(personCursors.parents);
+	stdfree(personCursors.children);
+	stdfree(personCursors.spouses);
+	stdfree(personCursors.childIn);
+	stdfree(personCursors.spouseIn);
+	if (debugging)
+		printf("Kinship graph: %d persons, %d families, %d parent edges, %d spouse edges.\n",
+			   numPersons, numFamilies, graph->parents.offsets[numPersons],
+			   graph->spouses.offsets[numPersons]);
+	return graph;
+}
+
+//  deleteEdges -- Free the arrays of a set of edges.
+//--------------------------------------------------------------------------------------------------
+static void deleteEdges(KinshipEdges *edges)
+{
+	stdfree(edges->offsets);
+	stdfree(edges->targets);
+}
+
+//  deleteKinshipGraph -- Delete a kinship graph. The database is not changed.
+//--------------------------------------------------------------------------------------------------
+void deleteKinshipGraph(KinshipGraph *graph)
+{
+	ASSERT(graph);
+	stdfree(graph->persons);
+	stdfree(graph->families);
+	deleteHashTable(graph->personIds);
+	deleteHashTable(graph->familyIds);
+	deleteEdges(&graph->parents);
+	deleteEdges(&graph->children);
+	deleteEdges(&graph->spouses);
+	deleteEdges(&graph->childIn);
+	deleteEdges(&graph->spouseIn);
+	deleteEdges(&graph->members);
+	stdfree(graph->numSpouses);
+	stdfree(graph);
+}
+
+//  kinshipPersonId -- Return the dense id of the person with a key, or -1 if there is none.
+//--------------------------------------------------------------------------------------------------
+int kinshipPersonId(KinshipGraph *graph, String key)
+{
+	ASSERT(graph);
+	return lookupId(graph->personIds, key);
+}
+
+//  kinshipFamilyId -- Return the dense id of the family with a key, or -1 if there is none.
+//--------------------------------------------------------------------------------------------------
+int kinshipFamilyId(KinshipGraph *graph, String key)
+{
+	ASSERT(graph);
+	return lookupId(graph->familyIds, key);
+}
+
+//  kinshipPerson -- Return the root of the person with a dense id. In a lazy database the person
+//    is read if it hasn't been.
+//--------------------------------------------------------------------------------------------------
+GNode *kinshipPerson(KinshipGraph *graph, int id)
+{
+	ASSERT(graph && id >= 0 && id < graph->numPersons);
+	return elementToRecord(graph->persons[id], graph->database);
+}
+
+//  kinshipFamily -- Return the root of the family with a dense id.
+//--------------------------------------------------------------------------------------------------
+GNode *kinshipFamily(KinshipGraph *graph, int id)
+{
+	ASSERT(graph && id >= 0 && id < graph->numFamilies);
+	return elementToRecord(graph->families[id], graph->database);
+}
+
+//  kinshipEdges -- Return the targets of the edges from a node, and set their number.
+//--------------------------------------------------------------------------------------------------
+int *kinshipEdges(KinshipEdges *edges, int id, int *count)
+//  edges -- Edges of a kinship graph.
+//  id -- Dense id of the node the edges are from.
+//  count -- (out) Number of edges.
+{
+	*count = edges->offsets[id + 1] - edges->offsets[id];
+	return edges->targets + edges->offsets[id];
+}
@@ -3,26 +3,18 @@
 //
 //  nameindex.c -- Implements a name index that is built with a hash table. Gedcom names are
 //    mapped to name keys. Name keys are the keys in the name index. The index maps the name
-//    keys to the list of keys of the persons who have names that map to the name key.
+//    keys to the record ids of the persons who have names that map to the name key.
+//
+//    Insertions are collected as postings. sortNameIndex moves them into the index's posting
+//    list, grouped by name key with each group sorted and without duplicates. Searches sort the
+//    index first if there are new postings, and return a pointer into the list's array.
 //
 //  Created by Thomas Wetmore on 26 November 2022.
-//  Last changed on 4 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "nameindex.h"
 #include "name.h"
-#include "sort.h"
-#include "set.h"
-#include "gedcom.h"
-
-// NameKeys -- Compare two name keys. This uses the standard strcmp.
-//--------------------------------------------------------------------------------------------------
-static int compareNameKeys(Word leftEl, Word rightEl)
-{
-	String a = ((NameElement*) leftEl)->nameKey;
-	String b = ((NameElement*) rightEl)->nameKey;
-	return strcmp(a, b);
-}
 
 // getNameKey -- Get the name key of an element.
 //--------------------------------------------------------------------------------------------------
@@ -35,111 +27,135 @@ static String getNameKey(Word element)
 //--------------------------------------------------------------------------------------------------
 static void deleteNameElement(Word element)
 {
-	NameElement *nameEl = (NameElement*) element;
-	stdfree(nameEl->nameKey);
-	deleteSet(nameEl->recordKeys);
-	stdfree(nameEl);
+	stdfree(element);
 }
 
-//  createNameIndex -- Create a name index from a hash table.
+//  createNameIndex -- Create an empty name index.
 //--------------------------------------------------------------------------------------------------
 NameIndex *createNameIndex(void)
 {
-	return createHashTable(compareNameKeys, deleteNameElement, getNameKey);
+	NameIndex *index = (NameIndex*) stdalloc(sizeof(NameIndex));
+	index->elements = createHashTable(null, deleteNameElement, getNameKey);
+	index->postings = createPostingList();
+	return index;
 }
 
 //  deleteNameIndex -- Delete a name index.
 //--------------------------------------------------------------------------------------------------
-void deleteNameIndex(NameIndex *nameIndex)
+void deleteNameIndex(NameIndex *index)
 {
-	deleteHashTable(nameIndex);
+	ASSERT(index);
+	deleteHashTable(index->elements);
+	deletePostingList(index->postings);
+	stdfree(index);
 }
 
-//  compareRecordKeysInSets -- Compare two record keys in a set of record keys in a name index.
-//    Uses compareRecordKeys.
-//-------------------------------------------------------------------------------------------------
-static int compareRecordKeysInSets(Word a, Word b)
+//  findElement -- Return the element of a name key in a name index, adding it if needed.
+//--------------------------------------------------------------------------------------------------
+static NameElement *findElement(NameIndex *index, String nameKey)
 {
-	return compareRecordKeys((String) a, (String) b);
+	NameElement *element = searchHashTable(index->elements, nameKey);
+	if (!element) {
+		element = (NameElement*) stdalloc(sizeof(NameElement));
+		strcpy(element->nameKey, nameKey);
+		element->group.offset = element->group.count = 0;
+		insertInHashTable(index->elements, element);
+	}
+	return element;
 }
 
-static String getRecordKey(Word element) { return (String) element; }
-
-//  insertNameIndex -- Add a (name key, person key) pair to a name index.
-//    MNOTE: Describe the memory situration of the two parameters.
+//  insertInNameIndex -- Add a (name key, record id) pair to a name index. The pair is a posting
+//    until the index is next sorted.
 //--------------------------------------------------------------------------------------------------
-void insertInNameIndex(NameIndex *index, String nameKey, String personKey)
+void insertInNameIndex(NameIndex *index, String nameKey, RecordId id)
 //  index -- Name index to update.
-//  nameKey -- Name key to insert.
-//  personKey -- Person key to insert.
+//  nameKey -- Name key to insert; it is copied.
+//  id -- Record id of the person.
 {
-	//  DEBUG:
-	//printf("insertInNameIndex: nameKey, personKey: %s, %s\n", nameKey, personKey);
-	//  Hash the name key to get a bucket index; create a bucket if it does not exist.
-	int hash = getHash(nameKey);
-	//  DEBUG
-	//printf("insertInNameIndex: hash: %d\n", hash);
-	Bucket *bucket = index->buckets[hash];
-	if (!bucket) {
-		// DEBUG
-		//printf("insertInNameIndex: bucket for nameKey doesn't exist.\n");
-		bucket = createBucket();
-		index->buckets[hash] = bucket;
-	}
+	ASSERT(index && nameKey && strlen(nameKey) < 6);
+	addPosting(index->postings, &findElement(index, nameKey)->group, id);
+}
 
-	//  See if there is an element for the name key; create if not.
-	NameElement *element = searchBucket(bucket, nameKey, index->compare, index->getKey, null);
-	if (!element) {
-		//  DEBUG
-		//printf("insertInNameIndex: element for nameKey %s doesn't exist.\n", nameKey);
-		element = (NameElement*) stdalloc(sizeof(NameElement));
-		element->nameKey = strsave(nameKey);  // MNOTE: nameKey is in data space.
-		element->recordKeys = createSet(compareRecordKeysInSets, null, getRecordKey);
-		appendToBucket(bucket, element);
-	}
-	//  Add the person key to element's set of person keys.
-	if (!isInSet(element->recordKeys, personKey))
-		//  DEBUG
-		//printf("insertInNameIndex: calling addToSet with personKey: %s\n", personKey);
-		addToSet(element->recordKeys, strsave(personKey));  //  MNOTE: personKey is in data space.
+//  mergeNameIndex -- Add the entries of a partial name index to a name index as postings. Merging
+//    partial indexes in record id order keeps the postings of each name key in order.
+//--------------------------------------------------------------------------------------------------
+void mergeNameIndex(NameIndex *index, NameIndex *partial)
+//  index -- Name index to add to.
+//  partial -- Name index to add; it is not changed except to be sorted.
+{
+	ASSERT(index && partial);
+	sortNameIndex(partial);
+	FORHASHTABLE(partial->elements, element)
+		NameElement *nameEl = (NameElement*) element;
+		NameElement *target = findElement(index, nameEl->nameKey);
+		RecordId *ids = partial->postings->ids + nameEl->group.offset;
+		for (int i = 0; i < nameEl->group.count; i++)
+			addPosting(index->postings, &target->group, ids[i]);
+	ENDHASHTABLE
+}
+
+//  sortNameIndex -- Move the postings of a name index into its posting list.
+//--------------------------------------------------------------------------------------------------
+void sortNameIndex(NameIndex *index)
+{
+	ASSERT(index);
+	if (index->postings->numPostings == 0) return;
+	IdGroup **groups = (IdGroup**) stdalloc((sizeHashTable(index->elements) + 1)*sizeof(IdGroup*));
+	int numGroups = 0;
+	FORHASHTABLE(index->elements, element)
+		groups[numGroups++] = &((NameElement*) element)->group;
+	ENDHASHTABLE
+	sortPostingList(index->postings, groups, numGroups);
+	stdfree(groups);
+}
+
+//  sizeNameIndex -- Return the number of name keys in a name index.
+//--------------------------------------------------------------------------------------------------
+int sizeNameIndex(NameIndex *index)
+{
+	ASSERT(index);
+	return sizeHashTable(index->elements);
+}
+
+//  searchNameIndexByKey -- Search a name index for a name key. Returns the sorted record ids of
+//    the persons with names with the key, and sets their number. The ids belong to the index and
+//    are good until it is next changed.
+//--------------------------------------------------------------------------------------------------
+RecordId *searchNameIndexByKey(NameIndex *index, String nameKey, int *count)
+//  index -- Name index to search.
+//  nameKey -- Name key to search for.
+//  count -- (out) Number of record ids.
+{
+	ASSERT(index && nameKey && count);
+	sortNameIndex(index);
+	NameElement *element = searchHashTable(index->elements, nameKey);
+	*count = element ? element->group.count : 0;
+	return element ? index->postings->ids + element->group.offset : null;
 }
 
 //  searchNameIndex -- Search a name index for a name.
 //--------------------------------------------------------------------------------------------------
-Set *searchNameIndex(NameIndex *index, String name)
-//  index -- Name index, a specialized hash table.
+RecordId *searchNameIndex(NameIndex *index, String name, int *count)
+//  index -- Name index to search.
 //  name -- Name being search for.
+//  count -- (out) Number of record ids.
 {
 	ASSERT(index && name);
-	String nameKey = nameToNameKey(name);
-	NameElement* element = searchHashTable(index, nameKey);
-	return element == null ? null : element->recordKeys;
+	return searchNameIndexByKey(index, nameToNameKey(name), count);
 }
 
 //  showNameIndex -- Show the contents of a name index; for debugging.
 //--------------------------------------------------------------------------------------------------
 void showNameIndex(NameIndex *index)
-//  index -- Name index, a specialized hash table.
+//  index -- Name index to show.
 {
 	ASSERT(index);
-	//  Iterate through the buckets.
-	for (int i = 0; i < MAX_HASH; i++) {
-		if (!index->buckets[i]) continue;  // Don't show anything for empty Buckets.
-		//  The ith Bucket has something in it.
-		Bucket *bucket = index->buckets[i];
-		//  A bucket contains a List of elements sorted by name key; get that list.
-		Word *elements = bucket->elements;
-		printf("Bucket %d:\n", i);
-		// Iterate through the elements of the ith Bucket.
-		for (int j = 0; j < bucket->length; j++) {
-			// An element is tuple of a name key and a set of person keys.
-			NameElement* element = elements[j];
-			printf("    Name key %s:\n", element->nameKey);
-			// Get the set of record keys in this element and show them.
-			Set *recordKeys = element->recordKeys;
-			for (int k = 0; k < lengthSet(recordKeys); k++) {
-				printf("        %s\n", (String) recordKeys->list->data[k]);
-			}
-		}
-	}
+	sortNameIndex(index);
+	FORHASHTABLE(index->elements, element)
+		// An element is a name key and the ids of its persons.
+		NameElement *nameEl = (NameElement*) element;
+		printf("    Name key %s:\n", nameEl->nameKey);
+		for (int k = 0; k < nameEl->group.count; k++)
+			printf("        %u\n", index->postings->ids[nameEl->group.offset + k]);
+	ENDHASHTABLE
 }
@@ -3,23 +3,28 @@
 //
 //  recordindex.c -- Data type that implements the indexes to person, family, etc, Gedcom records
 //    in their internal node tree form. A record index is a thin layer over the general hash table
-//    type. The type RecordIndex is a synonym of HashTable.
+//    type. The type RecordIndex is a synonym of HashTable. Also implements the posting lists
+//    the name and surname indexes keep their record ids in; sortPostingList groups the postings
+//    with a counting sort, which keeps the order they were added in, so postings added in record
+//    id order need no further sorting.
 //
 //  Created by Thomas Wetmore on 29 November 2022.
-//  Last changed on 31 October 2023.
+//  Last changed on 17 October 2026.
 //
 
+#include <stdatomic.h>
 #include "recordindex.h"
 #include "list.h"
 #include "sort.h"
 #include "gedcom.h"
+#include "name.h"
 
 //  RecordIndexEls -- Element compare function needed by the record index hash table.
 //--------------------------------------------------------------------------------------------------
 static int compareRecordIndexEls(Word leftEl, Word rightEl)
 {
-	String a = ((RecordIndexEl*) leftEl)->root->key;
-	String b = ((RecordIndexEl*) rightEl)->root->key;
+	String a = ((RecordIndexEl*) leftEl)->key;
+	String b = ((RecordIndexEl*) rightEl)->key;
 	return strcmp(a, b);
 }
 
@@ -28,13 +33,14 @@ static int compareRecordIndexEls(Word leftEl, Word rightEl)
 static void deleteRecordIndexEl(Word word)
 {
 	RecordIndexEl* element = (RecordIndexEl*) word;
+	if (element->nameForms) deleteNameForms(element->nameForms);
 	stdfree(element);
 }
 
 //  recordIndexElKey -- Return the key of record index element. This is the key of the root node.
 //--------------------------------------------------------------------------------------------------
 static String recordIndexElKey(Word word) {
-	return ((RecordIndexEl*) word)->root->key;
+	return ((RecordIndexEl*) word)->key;
 }
 
 //  createRecordIndex -- Create a record index. A record index is a hash table with its functions
@@ -52,41 +58,60 @@ void deleteRecordIndex(RecordIndex *index)
 	deleteHashTable(index);
 }
 
-//  insertInRecordIndex -- Add a (key, root) element to a record index. This function saves a
-//    copy of the key in the table. When elements are deleted the key strings should also be.
-//    TODO: Shouldn't this function create an element and then delegate to the hash table.
+//  insertElement -- Add an element for a key to a record index if there isn't one. Returns the new
+//    element, or null if the key is already in the index.
+//    TODO: Should there be a warning if the element exists?
 //--------------------------------------------------------------------------------------------------
-static int recordInsertCount = 0;  //  Used for debugging.
-void insertInRecordIndex(RecordIndex *index, String key, GNode* root, int lineNumber)
+static atomic_int recordInsertCount = 0;  //  Used for debugging.
+static RecordIndexEl *insertElement(RecordIndex *index, String key, int lineNumber)
+{
+	recordInsertCount++;  //  Debugging.
+	if (searchHashTable(index, key)) return null;
+	RecordIndexEl *element = (RecordIndexEl*) stdalloc(sizeof(RecordIndexEl));
+	element->root = null;
+	element->lineNumber = lineNumber;
+	element->key = key;  // MNOTE: Not copied; the key must live as long as the index.
+	element->start = element->end = null;
+	element->id = NORECORDID;  // The database gives the record its id.
+	element->nameForms = null;
+	insertInHashTable(index, element);
+	return element;
+}
+
+//  insertUnreadInRecordIndex -- Add an element for a record that has not been read to a record
+//    index. The element holds the location of the record's text so it can be read when needed.
+//    Returns the element, or null if the key is already in the index.
+//--------------------------------------------------------------------------------------------------
+RecordIndexEl *insertUnreadInRecordIndex(RecordIndex *index, String key, String start, String end,
+							   int lineNumber)
+//  index -- Record index to add the element to.
+//  key -- Key of the record; it must live as long as the index.
+//  start -- Start of the record's text.
+//  end -- End of the record's text.
+//  lineNumber -- Line number where the record begins in the Gedcom file.
+{
+	ASSERT(index && key && start && end);
+	RecordIndexEl *element = insertElement(index, key, lineNumber);
+	if (!element) return null;
+	element->start = start;
+	element->end = end;
+	return element;
+}
+
+//  insertInRecordIndex -- Add a (key, root) element to a record index. The key is not copied; it
+//    is normally the key of the root. Returns the element, or null if the key is already in the
+//    index.
+//--------------------------------------------------------------------------------------------------
+RecordIndexEl *insertInRecordIndex(RecordIndex *index, String key, GNode* root, int lineNumber)
 //  index -- Record index to add the (key, root) entry to.
 //  key -- Key (minus @-signs) of a Gedcom node record.
 //  root -- Root of the Gedom record.
 //  lineNumber -- Line number where the record was found in the Gedcom file.
 {
-	recordInsertCount++;  //  Debugging.
 	ASSERT(index && key && root);
-	//  Hash the record key to get the bucket. If the bucket doesn't exist, create it.
-	int hash = getHash(key);
-	Bucket *bucket = index->buckets[hash];
-	if (!bucket) {
-		bucket = createBucket();
-		index->buckets[hash] = bucket;
-	}
-
-	// See if there is an element for the key. If not create one and insert it.
-	RecordIndexEl* element = searchBucket(bucket, key, index->compare,  index->getKey, null);
-	// TODO. Note the index pointer is null above. If we used it, we could insert faster below.
-	if (!element) {
-		element = (RecordIndexEl*) stdalloc(sizeof(RecordIndexEl));
-		//element->key = strsave(key);
-		element->root = root;  //  MNOTE: Not copied, records persist.
-		element->lineNumber = lineNumber;
-		appendToBucket(bucket, element);
-	} //else {
-		//printf("The element exists\n");  //  Debugging.
-	//}
-	// TODO: Should there be a warning if the element exists?
-	// TODO: Should it be an error if the element exists?
+	RecordIndexEl *element = insertElement(index, key, lineNumber);
+	if (element) element->root = root;  //  MNOTE: Not copied, records persist.
+	return element;
 }
 
 //  getRecordInsertCount -- Return the record insert count. For debugging.
@@ -96,35 +121,129 @@ int getRecordInsertCount(void)
 	return recordInsertCount;
 }
 
-//  searchRecordIndex -- Search a record index for a key, and return the associated node tree.
+// showRecordIndex -- Show the contents of a RecordIndex. For debugging.
 //--------------------------------------------------------------------------------------------------
-GNode* searchRecordIndex(RecordIndex *index, String key)
-// index -- Record index to search for the key in.
-// key -- Key of record to search for.
+void showRecordIndex(RecordIndex *index)
 {
-	ASSERT(index && key);
-	RecordIndexEl* element = searchHashTable(index, key);
-	return element == null ? null : element->root;
+	FORHASHTABLE(index, element)
+		printf("    Key %s\n", ((RecordIndexEl*) element)->key);
+	ENDHASHTABLE
 }
 
-// showRecordIndex -- Show the contents of a RecordIndex. For debugging.
+//  createPostingList -- Create an empty posting list.
 //--------------------------------------------------------------------------------------------------
-void showRecordIndex(RecordIndex *index)
+PostingList *createPostingList(void)
 {
-	//  Loop through the buckets.
-	for (int i = 0; i < MAX_HASH; i++) {
+	PostingList *list = (PostingList*) stdalloc(sizeof(PostingList));
+	list->ids = null;
+	list->numIds = 0;
+	list->postings = null;
+	list->numPostings = list->maxPostings = 0;
+	return list;
+}
 
-		//  Ignore empty buckets.
-		if (!index->buckets[i]) continue;
+//  deletePostingList -- Delete a posting list.
+//--------------------------------------------------------------------------------------------------
+void deletePostingList(PostingList *list)
+{
+	ASSERT(list);
+	if (list->ids) stdfree(list->ids);
+	if (list->postings) stdfree(list->postings);
+	stdfree(list);
+}
 
-		Bucket *bucket = index->buckets[i];
-		Word* elements = bucket->elements;
-		printf("Bucket %d\n", i);
+//  addPosting -- Add a posting of a record id to a group of a posting list.
+//--------------------------------------------------------------------------------------------------
+void addPosting(PostingList *list, IdGroup *group, RecordId id)
+{
+	if (list->numPostings == list->maxPostings) {
+		int max = list->maxPostings ? 2*list->maxPostings : 1024;
+		Posting *postings = (Posting*) stdalloc(max*sizeof(Posting));
+		if (list->postings) {
+			memcpy(postings, list->postings, list->numPostings*sizeof(Posting));
+			stdfree(list->postings);
+		}
+		list->postings = postings;
+		list->maxPostings = max;
+	}
+	list->postings[list->numPostings].group = group;
+	list->postings[list->numPostings++].id = id;
+}
+
+//  compareIds -- Compare two record ids; used with qsort.
+//--------------------------------------------------------------------------------------------------
+static int compareIds(const void *a, const void *b)
+{
+	RecordId x = *(const RecordId*) a, y = *(const RecordId*) b;
+	return x < y ? -1 : x > y;
+}
 
-		// Loop through the elements in the ith Bucket.
-		for (int j = 0; j < bucket->length; j++) {
-			RecordIndexEl* element = elements[j];
-			printf("    Key %s\n", element->root->key);
+//  uniqueIds -- Sort a group of record ids, if it isn't already, and remove its duplicates.
+//    Returns the new number of ids.
+//--------------------------------------------------------------------------------------------------
+int uniqueIds(RecordId *ids, int count)
+{
+	if (count < 2) return count;
+	for (int i = 1; i < count; i++) {
+		if (ids[i] < ids[i - 1]) {
+			qsort(ids, count, sizeof(RecordId), compareIds);
+			break;
 		}
 	}
+	int j = 0;
+	for (int i = 1; i < count; i++)
+		if (ids[i] != ids[j]) ids[++j] = ids[i];
+	return j + 1;
+}
+
+//  sortPostingList -- Move the postings of a posting list into its array of record ids. The
+//    groups are laid out in the order given, and each group's ids are sorted and without
+//    duplicates. Every group with ids or postings must be given.
+//--------------------------------------------------------------------------------------------------
+void sortPostingList(PostingList *list, IdGroup **groups, int numGroups)
+//  list -- Posting list to sort.
+//  groups -- Groups of the list in the order their ids are to be in.
+//  numGroups -- Number of groups.
+{
+	ASSERT(list);
+	if (list->numPostings == 0) return;
+
+	//  Count the ids each group will have.
+	for (int i = 0; i < numGroups; i++) groups[i]->fill = groups[i]->count;
+	for (int i = 0; i < list->numPostings; i++) list->postings[i].group->fill++;
+
+	//  Give each group its part of a new array and copy the ids it has into it.
+	int total = list->numIds + list->numPostings;
+	RecordId *ids = (RecordId*) stdalloc((total + 1)*sizeof(RecordId));
+	int offset = 0;
+	for (int i = 0; i < numGroups; i++) {
+		IdGroup *group = groups[i];
+		int size = group->fill;
+		if (group->count)
+			memcpy(ids + offset, list->ids + group->offset, group->count*sizeof(RecordId));
+		group->fill = offset + group->count;
+		group->offset = offset;
+		offset += size;
+	}
+
+	//  Add the postings, then sort each group, remove its duplicates, and close the gaps.
+	for (int i = 0; i < list->numPostings; i++) {
+		Posting *posting = list->postings + i;
+		ids[posting->group->fill++] = posting->id;
+	}
+	int numIds = 0;
+	for (int i = 0; i < numGroups; i++) {
+		IdGroup *group = groups[i];
+		int count = uniqueIds(ids + group->offset, group->fill - group->offset);
+		memmove(ids + numIds, ids + group->offset, count*sizeof(RecordId));
+		group->offset = numIds;
+		group->count = count;
+		numIds += count;
+	}
+	if (list->ids) stdfree(list->ids);
+	list->ids = ids;
+	list->numIds = numIds;
+	stdfree(list->postings);
+	list->postings = null;
+	list->numPostings = list->maxPostings = 0;
 }
@@ -0,0 +1,314 @@
+//
+//  DeadEnds
+//
+//  snapshot.c -- Functions that save databases to binary snapshot files and load them back. A
+//    snapshot holds the records in NodeStore form, the line numbers of the records, and the name
+//    and surname indexes. Loading a snapshot reads a few large arrays and links GNodes into the
+//    database, which is much faster than importing the Gedcom file and indexing the names.
+//
+//    A snapshot records the size and modification time of the Gedcom file it was made from. If
+//    the Gedcom file has changed the snapshot is stale and is not loaded.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#include <sys/stat.h>
+#include "snapshot.h"
+#include "nodestore.h"
+#include "nameindex.h"
+#include "surnameindex.h"
+#include "recordindex.h"
+
+static bool debugging = false;
+
+//  SnapshotHeader -- First bytes of a snapshot file.
+//--------------------------------------------------------------------------------------------------
+typedef struct SnapshotHeader {
+	char magic[8];        // "DESNAP" followed by zeros.
+	uint32_t version;     // SNAPSHOTVERSION when the snapshot was written.
+	uint32_t nodeSize;    // Size of a CompactNode, to catch snapshots from other builds.
+	int64_t gedcomSize;   // Size of the Gedcom file the snapshot was made from.
+	int64_t gedcomTime;   // Modification time of the Gedcom file.
+	uint64_t nameBytes;   // Size of the name index section.
+	uint64_t surnameBytes;  // Size of the surname index section.
+} SnapshotHeader;
+
+static const char snapshotMagic[8] = "DESNAP";
+
+//  gedcomFileStamp -- Get the size and modification time of a Gedcom file. Returns false if the
+//    file cannot be found.
+//--------------------------------------------------------------------------------------------------
+static bool gedcomFileStamp(String gedcomFile, int64_t *size, int64_t *time)
+{
+	struct stat status;
+	if (stat(gedcomFile, &status) != 0) return false;
+	*size = status.st_size;
+	*time = status.st_mtime;
+	return true;
+}
+
+//  appendBytes -- Append bytes to a growing buffer.
+//--------------------------------------------------------------------------------------------------
+static void appendBytes(String *buffer, size_t *length, size_t *max, Word bytes, size_t count)
+{
+	if (*length + count > *max) {
+		while (*length + count > *max) *max *= 2;
+		String newBuffer = stdalloc(*max);
+		memcpy(newBuffer, *buffer, *length);
+		stdfree(*buffer);
+		*buffer = newBuffer;
+	}
+	memcpy(*buffer + *length, bytes, count);
+	*length += count;
+}
+
+//  appendPostings -- Append a key, the number of its records, and their positions in the node
+//    store to a section of a snapshot. Records that aren't in the node store are left out.
+//--------------------------------------------------------------------------------------------------
+static void appendPostings(String *buffer, size_t *length, size_t *max, String key, RecordId *ids,
+						   int count, uint32_t *positions)
+{
+	uint32_t numPositions = 0;
+	for (int i = 0; i < count; i++)
+		if (positions[ids[i]] != UINT32_MAX) numPositions++;
+	if (numPositions == 0) return;
+	appendBytes(buffer, length, max, key, strlen(key) + 1);
+	appendBytes(buffer, length, max, &numPositions, sizeof(numPositions));
+	for (int i = 0; i < count; i++)
+		if (positions[ids[i]] != UINT32_MAX)
+			appendBytes(buffer, length, max, &positions[ids[i]], sizeof(uint32_t));
+}
+
+//  nameIndexToBytes -- Convert a name index to the bytes of the name section of a snapshot. Each
+//    name key is followed by the number of its records and their positions in the node store.
+//--------------------------------------------------------------------------------------------------
+static String nameIndexToBytes(NameIndex *index, uint32_t *positions, size_t *length)
+//  index -- Name index to convert.
+//  positions -- Positions in the node store of the records, by record id; UINT32_MAX if none.
+//  length -- (out) Number of bytes.
+{
+	size_t max = 65536;
+	String buffer = stdalloc(max);
+	*length = 0;
+	sortNameIndex(index);
+	FORHASHTABLE(index->elements, element)
+		NameElement *nameEl = (NameElement*) element;
+		appendPostings(&buffer, length, &max, nameEl->nameKey,
+					   index->postings->ids + nameEl->group.offset, nameEl->group.count, positions);
+	ENDHASHTABLE
+	return buffer;
+}
+
+//  surnameIndexToBytes -- Convert a surname index to the bytes of the surname section of a
+//    snapshot, in the same form as the name section.
+//--------------------------------------------------------------------------------------------------
+static String surnameIndexToBytes(SurnameIndex *index, uint32_t *positions, size_t *length)
+{
+	size_t max = 65536;
+	String buffer = stdalloc(max);
+	*length = 0;
+	sortSurnameIndex(index);
+	for (int i = 0; i < index->numSorted; i++) {
+		SurnameElement *element = index->sorted[i];
+		IdGroup *group = &element->group;
+		appendPostings(&buffer, length, &max, element->surname,
+					   index->postings->ids + group->offset, group->count, positions);
+	}
+	return buffer;
+}
+
+//  saveSnapshot -- Write a database to a snapshot file. The file is written under a temporary
+//    name and renamed, so other processes never see a partial snapshot. Returns false if the
+//    snapshot could not be written.
+//--------------------------------------------------------------------------------------------------
+bool saveSnapshot(Database *database, String snapshotFile)
+//  database -- Database to save; its name index should be built.
+//  snapshotFile -- Name of the snapshot file.
+{
+	ASSERT(database && snapshotFile);
+	SnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, snapshotMagic, sizeof(header.magic));
+	header.version = SNAPSHOTVERSION;
+	header.nodeSize = sizeof(CompactNode);
+	if (!gedcomFileStamp(database->fileName, &header.gedcomSize, &header.gedcomTime)) return false;
+
+	//  Copy the records into a node store, keeping their line numbers in the same order.
+	RecordIndex *indexes[] = {database->personIndex, database->familyIndex, database->sourceIndex,
+							  database->eventIndex, database->otherIndex};
+	int numRecords = 0;
+	for (int i = 0; i < 5; i++) numRecords += sizeHashTable(indexes[i]);
+	int32_t *lineNumbers = (int32_t*) stdalloc((numRecords + 1)*sizeof(int32_t));
+	uint32_t *positions = (uint32_t*) stdalloc((database->numRecords + 1)*sizeof(uint32_t));
+	memset(positions, 0xff, (database->numRecords + 1)*sizeof(uint32_t));
+	NodeStore *store = createNodeStore();
+	for (int i = 0; i < 5; i++) {
+		FORHASHTABLE(indexes[i], element)
+			RecordIndexEl *recordEl = (RecordIndexEl*) element;
+			GNode *root = elementToRecord(recordEl, database);
+			if (!root) continue;
+			addToNodeStore(store, root);
+			lineNumbers[store->numRoots - 1] = recordEl->lineNumber;
+			positions[recordEl->id] = store->numRoots - 1;
+		ENDHASHTABLE
+	}
+	size_t nameBytes;
+	String names = nameIndexToBytes(database->nameIndex, positions, &nameBytes);
+	header.nameBytes = nameBytes;
+	size_t surnameBytes;
+	String surnames = surnameIndexToBytes(database->surnameIndex, positions, &surnameBytes);
+	header.surnameBytes = surnameBytes;
+
+	//  Write the snapshot.
+	int tempLength = snprintf(null, 0, "%s.%d", snapshotFile, (int) getpid());
+	String tempFile = stdalloc(tempLength + 1);
+	snprintf(tempFile, tempLength + 1, "%s.%d", snapshotFile, (int) getpid());
+	FILE *file = fopen(tempFile, "wb");
+	bool okay = file
+		&& fwrite(&header, sizeof(header), 1, file) == 1
+		&& writeNodeStore(store, file)
+		&& fwrite(lineNumbers, sizeof(int32_t), store->numRoots, file) == store->numRoots
+		&& fwrite(names, 1, nameBytes, file) == nameBytes
+		&& fwrite(surnames, 1, surnameBytes, file) == surnameBytes;
+	if (file && fclose(file) != 0) okay = false;
+	if (okay) okay = rename(tempFile, snapshotFile) == 0;
+	if (!okay && file) unlink(tempFile);
+	if (debugging) printf("saveSnapshot: %u records, %zu name bytes, %s\n", store->numRoots,
+						  nameBytes, okay ? "saved" : "failed");
+	stdfree(tempFile);
+	stdfree(names);
+	stdfree(surnames);
+	stdfree(lineNumbers);
+	stdfree(positions);
+	deleteNodeStore(store);
+	return okay;
+}
+
+//  Inserters -- Functions that add a posting read from a snapshot section to an index.
+//--------------------------------------------------------------------------------------------------
+static void insertName(Word index, String key, RecordId id)
+{
+	insertInNameIndex(index, key, id);
+}
+
+static void insertSurname(Word index, String key, RecordId id)
+{
+	insertInSurnameIndex(index, key, id);
+}
+
+//  bytesToPostings -- Add the postings of a name or surname section of a snapshot to an index.
+//    The records were stored in node store order, so their positions are their record ids.
+//    Returns false if the section is malformed.
+//--------------------------------------------------------------------------------------------------
+static bool bytesToPostings(String bytes, size_t length, int numRecords, size_t maxKeyLength,
+							void (*insert)(Word, String, RecordId), Word index)
+//  bytes, length -- The section.
+//  numRecords -- Number of records in the database.
+//  maxKeyLength -- Length of the longest key the index allows.
+//  insert -- Function that adds a posting to the index.
+//  index -- Index to add to.
+{
+	String end = bytes + length;
+	while (bytes < end) {
+		String key = bytes;
+		String zero = memchr(bytes, 0, end - bytes);
+		if (!zero || zero - key > maxKeyLength || end - (zero + 1) < sizeof(uint32_t)) return false;
+		uint32_t count;
+		memcpy(&count, zero + 1, sizeof(count));
+		bytes = zero + 1 + sizeof(count);
+		if ((end - bytes)/sizeof(uint32_t) < count) return false;
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t id;
+			memcpy(&id, bytes, sizeof(id));
+			if (id >= numRecords) return false;
+			insert(index, key, id);
+			bytes += sizeof(id);
+		}
+	}
+	return true;
+}
+
+//  loadSnapshot -- Load a database from a snapshot file. Returns null if the snapshot is missing,
+//    was written by a different version, does not match the current Gedcom file, or is damaged.
+//    The records are allocated in an arena and their strings are in the database's node store.
+//--------------------------------------------------------------------------------------------------
+Database *loadSnapshot(String snapshotFile, String gedcomFile)
+//  snapshotFile -- Name of the snapshot file.
+//  gedcomFile -- Name of the Gedcom file the snapshot was made from.
+{
+	ASSERT(snapshotFile && gedcomFile);
+	FILE *file = fopen(snapshotFile, "rb");
+	if (!file) return null;
+	SnapshotHeader header;
+	int64_t gedcomSize, gedcomTime;
+	if (fread(&header, sizeof(header), 1, file) != 1
+		|| memcmp(header.magic, snapshotMagic, sizeof(header.magic)) != 0
+		|| header.version != SNAPSHOTVERSION || header.nodeSize != sizeof(CompactNode)
+		|| !gedcomFileStamp(gedcomFile, &gedcomSize, &gedcomTime)
+		|| header.gedcomSize != gedcomSize || header.gedcomTime != gedcomTime) {
+		if (debugging) printf("loadSnapshot: %s is missing a header or is stale\n", snapshotFile);
+		fclose(file);
+		return null;
+	}
+	NodeStore *store = readNodeStore(file);
+	if (!store) {
+		fclose(file);
+		return null;
+	}
+	int32_t *lineNumbers = (int32_t*) stdalloc((store->numRoots + 1)*sizeof(int32_t));
+	String names = stdalloc(header.nameBytes + 1);
+	String surnames = stdalloc(header.surnameBytes + 1);
+	bool okay = fread(lineNumbers, sizeof(int32_t), store->numRoots, file) == store->numRoots
+		&& fread(names, 1, header.nameBytes, file) == header.nameBytes
+		&& fread(surnames, 1, header.surnameBytes, file) == header.surnameBytes;
+	fclose(file);
+
+	//  Link the records into a new database.
+	Database *database = createDatabase(gedcomFile);
+	database->nodeStore = store;
+	database->arena = createArena(0);
+	for (uint32_t i = 0; okay && i < store->numRoots; i++) {
+		GNode *root = nodeStoreToGNodes(store, store->roots[i], database->arena);
+		if (!root->key) okay = false;
+		else okay = storeRecord(database, root, lineNumbers[i]) && database->numRecords == i + 1;
+	}
+	releaseNodes(store);  // Only the strings are used by the records.
+	if (okay) okay = bytesToPostings(names, header.nameBytes, database->numRecords, 5,
+									 insertName, database->nameIndex);
+	if (okay) okay = bytesToPostings(surnames, header.surnameBytes, database->numRecords,
+									 MAXLINELEN, insertSurname, database->surnameIndex);
+	if (okay) {
+		sortNameIndex(database->nameIndex);
+		sortSurnameIndex(database->surnameIndex);
+	}
+	stdfree(lineNumbers);
+	stdfree(names);
+	stdfree(surnames);
+	if (!okay) {
+		deleteDatabase(database);
+		return null;
+	}
+	return database;
+}
+
+//  loadDatabase -- Load a database from a snapshot if there is a current one. Otherwise import
+//    the Gedcom file, index its names, and write a new snapshot for next time. A snapshot is not
+//    written if the import had errors.
+//--------------------------------------------------------------------------------------------------
+Database *loadDatabase(String gedcomFile, String snapshotFile, ImportOptions *options,
+					   ErrorLog *errorLog)
+//  gedcomFile -- Name of the Gedcom file.
+//  snapshotFile -- Name of the snapshot file.
+//  options -- Options used if the Gedcom file must be imported; null for the defaults.
+//  errorLog -- Error log.
+{
+	ASSERT(gedcomFile && snapshotFile);
+	Database *database = loadSnapshot(snapshotFile, gedcomFile);
+	if (database) return database;
+	int numErrors = lengthList(errorLog);
+	if (!(database = importFromFileWithOptions(gedcomFile, options, errorLog))) return null;
+	indexNames(database);
+	if (lengthList(errorLog) == numErrors) saveSnapshot(database, snapshotFile);
+	return database;
+}
@@ -0,0 +1,220 @@
+//
+//  DeadEnds
+//
+//  surnameindex.c -- Implements the surname index. Surnames are kept in upper case, and lookups
+//    fold their arguments the same way, so "wetm" finds Wetmore. Like the name index, insertions
+//    are collected in a posting list and sorted into it together; the surnames are also sorted
+//    so that a prefix lookup is two binary searches.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#include "surnameindex.h"
+#include "sort.h"
+
+#define MAXSURNAMELEN 512  // Longest surname or prefix looked up; longer ones are cut.
+
+static String getSurnameKey(Word element) { return ((SurnameElement*) element)->surname; }
+
+//  deleteSurnameElement -- Free a surname element and its surname.
+//--------------------------------------------------------------------------------------------------
+static void deleteSurnameElement(Word element)
+{
+	stdfree(((SurnameElement*) element)->surname);
+	stdfree(element);
+}
+
+//  foldSurname -- Copy a surname into a buffer in upper case.
+//--------------------------------------------------------------------------------------------------
+static String foldSurname(String surname, String buffer)
+{
+	int i = 0;
+	for (; surname[i] && i < MAXSURNAMELEN; i++) buffer[i] = toupper((unsigned char) surname[i]);
+	buffer[i] = 0;
+	return buffer;
+}
+
+//  createSurnameIndex -- Create an empty surname index.
+//--------------------------------------------------------------------------------------------------
+SurnameIndex *createSurnameIndex(void)
+{
+	SurnameIndex *index = (SurnameIndex*) stdalloc(sizeof(SurnameIndex));
+	index->elements = createHashTable(null, deleteSurnameElement, getSurnameKey);
+	index->sorted = null;
+	index->numSorted = 0;
+	index->postings = createPostingList();
+	return index;
+}
+
+//  deleteSurnameIndex -- Delete a surname index.
+//--------------------------------------------------------------------------------------------------
+void deleteSurnameIndex(SurnameIndex *index)
+{
+	ASSERT(index);
+	deleteHashTable(index->elements);
+	if (index->sorted) stdfree(index->sorted);
+	deletePostingList(index->postings);
+	stdfree(index);
+}
+
+//  findElement -- Return the element of a folded surname, adding it if needed.
+//--------------------------------------------------------------------------------------------------
+static SurnameElement *findElement(SurnameIndex *index, String surname)
+{
+	SurnameElement *element = searchHashTable(index->elements, surname);
+	if (!element) {
+		element = (SurnameElement*) stdalloc(sizeof(SurnameElement));
+		element->surname = strsave(surname);
+		element->group.offset = element->group.count = 0;
+		insertInHashTable(index->elements, element);
+	}
+	return element;
+}
+
+//  insertInSurnameIndex -- Add a (surname, record id) pair to a surname index. The surname is
+//    folded to upper case and copied.
+//--------------------------------------------------------------------------------------------------
+void insertInSurnameIndex(SurnameIndex *index, String surname, RecordId id)
+{
+	ASSERT(index && surname);
+	char folded[MAXSURNAMELEN + 1];
+	addPosting(index->postings, &findElement(index, foldSurname(surname, folded))->group, id);
+}
+
+//  mergeSurnameIndex -- Add the entries of a partial surname index to a surname index as
+//    postings. Merging partial indexes in record id order keeps each surname's postings in order.
+//--------------------------------------------------------------------------------------------------
+void mergeSurnameIndex(SurnameIndex *index, SurnameIndex *partial)
+{
+	ASSERT(index && partial);
+	sortSurnameIndex(partial);
+	for (int i = 0; i < partial->numSorted; i++) {
+		SurnameElement *element = partial->sorted[i];
+		SurnameElement *target = findElement(index, element->surname);
+		RecordId *ids = partial->postings->ids + element->group.offset;
+		for (int j = 0; j < element->group.count; j++)
+			addPosting(index->postings, &target->group, ids[j]);
+	}
+}
+
+//  compareSurnames -- Compare two surname elements by surname; used with quickSort.
+//--------------------------------------------------------------------------------------------------
+static int compareSurnames(Word a, Word b)
+{
+	return strcmp(((SurnameElement*) a)->surname, ((SurnameElement*) b)->surname);
+}
+
+//  sortSurnameIndex -- Sort the surnames of a surname index, and move its postings into its
+//    posting list in surname order.
+//--------------------------------------------------------------------------------------------------
+void sortSurnameIndex(SurnameIndex *index)
+{
+	ASSERT(index);
+	if (index->postings->numPostings == 0) return;
+	int numElements = sizeHashTable(index->elements);
+	SurnameElement **sorted =
+		(SurnameElement**) stdalloc((numElements + 1)*sizeof(SurnameElement*));
+	int n = 0;
+	FORHASHTABLE(index->elements, element)
+		sorted[n++] = (SurnameElement*) element;
+	ENDHASHTABLE
+	if (n > 1) {
+		ldata = (Word*) sorted;
+		lcmp = compareSurnames;
+		quickSort(0, n - 1);
+	}
+	IdGroup **groups = (IdGroup**) stdalloc((n + 1)*sizeof(IdGroup*));
+	for (int i = 0; i < n; i++) groups[i] = &sorted[i]->group;
+	sortPostingList(index->postings, groups, n);
+	stdfree(groups);
+	if (index->sorted) stdfree(index->sorted);
+	index->sorted = sorted;
+	index->numSorted = n;
+}
+
+//  sizeSurnameIndex -- Return the number of surnames in a surname index.
+//--------------------------------------------------------------------------------------------------
+int sizeSurnameIndex(SurnameIndex *index)
+{
+	ASSERT(index);
+	return sizeHashTable(index->elements);
+}
+
+//  surnamesWithPrefix -- Return the surname elements, in order, whose surnames start with a
+//    prefix, and set their number. Finding them takes two binary searches. The elements belong
+//    to the index and are good until it is next changed.
+//--------------------------------------------------------------------------------------------------
+SurnameElement **surnamesWithPrefix(SurnameIndex *index, String prefix, int *count)
+//  index -- Surname index to search.
+//  prefix -- Prefix of the surnames; the case of its letters does not matter.
+//  count -- (out) Number of surnames.
+{
+	ASSERT(index && prefix && count);
+	sortSurnameIndex(index);
+	char folded[MAXSURNAMELEN + 1];
+	foldSurname(prefix, folded);
+	int length = (int) strlen(folded);
+
+	//  Find the first surname not less than the prefix, then the first after it without it.
+	int low = 0, high = index->numSorted;
+	while (low < high) {
+		int middle = (low + high)/2;
+		if (strcmp(index->sorted[middle]->surname, folded) < 0) low = middle + 1;
+		else high = middle;
+	}
+	int first = low;
+	high = index->numSorted;
+	while (low < high) {
+		int middle = (low + high)/2;
+		if (strncmp(index->sorted[middle]->surname, folded, length) <= 0) low = middle + 1;
+		else high = middle;
+	}
+	*count = low - first;
+	return index->sorted + first;
+}
+
+//  searchSurnamePrefix -- Return the record ids of the persons with surnames that start with a
+//    prefix, and set their number. The ids are grouped by surname, so a person with two such
+//    surnames is there twice. The ids belong to the index.
+//--------------------------------------------------------------------------------------------------
+RecordId *searchSurnamePrefix(SurnameIndex *index, String prefix, int *count)
+{
+	int numSurnames;
+	SurnameElement **surnames = surnamesWithPrefix(index, prefix, &numSurnames);
+	if (numSurnames == 0) {
+		*count = 0;
+		return null;
+	}
+	IdGroup *first = &surnames[0]->group, *last = &surnames[numSurnames - 1]->group;
+	*count = last->offset + last->count - first->offset;
+	return index->postings->ids + first->offset;
+}
+
+//  personsWithSurnamePrefix -- Return the record ids of the persons with surnames that start with
+//    a prefix, sorted and without duplicates, and set their number. The caller frees the ids.
+//--------------------------------------------------------------------------------------------------
+RecordId *personsWithSurnamePrefix(SurnameIndex *index, String prefix, int *count)
+{
+	int num;
+	RecordId *found = searchSurnamePrefix(index, prefix, &num);
+	*count = 0;
+	if (num == 0) return null;
+	RecordId *ids = (RecordId*) stdalloc(num*sizeof(RecordId));
+	memcpy(ids, found, num*sizeof(RecordId));
+	*count = uniqueIds(ids, num);
+	return ids;
+}
+
+//  searchSurnameIndex -- Return the sorted record ids of the persons with a surname, and set
+//    their number. The case of the letters of the surname does not matter.
+//--------------------------------------------------------------------------------------------------
+RecordId *searchSurnameIndex(SurnameIndex *index, String surname, int *count)
+{
+	ASSERT(index && surname && count);
+	sortSurnameIndex(index);
+	char folded[MAXSURNAMELEN + 1];
+	SurnameElement *element = searchHashTable(index->elements, foldSurname(surname, folded));
+	*count = element ? element->group.count : 0;
+	return element ? index->postings->ids + element->group.offset : null;
+}
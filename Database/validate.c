@@ -4,7 +4,7 @@
 //  validate.c -- Functions that validate Gedcom records.
 //
 //  Created by Thomas Wetmore on 12 April 2023.
-//  Last changed on 16 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "validate.h"
@@ -47,8 +47,8 @@ bool validateDatabase(Database *database, ErrorLog *errorLog)
 bool validatePersonIndex(Database *database, ErrorLog *errorLog)
 {
 	FORHASHTABLE(database->personIndex, element)
-		GNode* person = ((RecordIndexEl*) element)->root;
-		validatePerson(person, database, errorLog);
+		GNode* person = elementToRecord((RecordIndexEl*) element, database);
+		if (person) validatePerson(person, database, errorLog);
 	ENDHASHTABLE
 	return true;
 }
@@ -58,8 +58,8 @@ bool validatePersonIndex(Database *database, ErrorLog *errorLog)
 bool validateFamilyIndex(Database *database, ErrorLog *errorLog)
 {
 	FORHASHTABLE(database->familyIndex, element)
-		GNode *family = ((RecordIndexEl*) element)->root;
-		validateFamily(family, database, errorLog);
+		GNode *family = elementToRecord((RecordIndexEl*) element, database);
+		if (family) validateFamily(family, database, errorLog);
 	ENDHASHTABLE
 	return true;
 }
@@ -156,16 +156,3 @@ void validateSource(GNode *source, Database *database, ErrorLog* errorLog) {}
 void validateEvent(GNode *event, Database *database, ErrorLog* errorLog) {}
 
 void validateOther(GNode *other, Database *database, ErrorLog* errorLog) {}
-
-
-static GNode *getFamily(String key, RecordIndex *index)
-{
-	GNode *root = searchRecordIndex(index, key);
-	return root && recordType(root) == GRFamily ? root : null;
-}
-
-static GNode *getPerson(String key, RecordIndex *index)
-{
-	GNode *root = searchRecordIndex(index, key);
-	return root && recordType(root) == GRPerson ? root : null;
-}
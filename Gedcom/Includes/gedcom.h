@@ -4,7 +4,7 @@
 //  gedcom.h
 //
 //  Created by Thomas Wetmore on 7 November 2022.
-//  Last changed on 14 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef gedcom_h
@@ -31,9 +31,16 @@ typedef enum RecordType {
 } RecordType;
 
 RecordType recordType(GNode *root);  // Return the type of a Gedcom record tree.
+RecordType tagToRecordType(String tag);  // Return the type of a record with a root tag.
 
 int compareRecordKeys(String, String);  // gedcom.c
 
+//  LINKTOPERSON, LINKTOFAMILY -- Return the record a link node refers to. The resolved link is
+//    used if there is one; otherwise the node's value is looked up in the database.
+//--------------------------------------------------------------------------------------------------
+#define LINKTOPERSON(node, database) ((node)->link ? (node)->link : keyToPerson((node)->value, database))
+#define LINKTOFAMILY(node, database) ((node)->link ? (node)->link : keyToFamily((node)->value, database))
+
 // FORCHILDREN / ENDCHILDREN -- Iterator for the children of a family.
 //--------------------------------------------------------------------------------------------------
 #define FORCHILDREN(fam, childd, num, database) \
@@ -42,7 +49,7 @@ int compareRecordKeys(String, String);  // gedcom.c
     GNode* childd;\
     int num = 0;\
     while (__node) {\
-        childd = keyToPerson(__node->value, database);\
+        childd = LINKTOPERSON(__node, database);\
         ASSERT(childd);\
         num++;\
         {
@@ -59,7 +66,7 @@ int compareRecordKeys(String, String);  // gedcom.c
     GNode *__node = FAMS(indi);\
     GNode *fam;\
     while (__node) {\
-        fam = keyToFamily(__node->value, database);\
+        fam = LINKTOFAMILY(__node, database);\
         ASSERT(fam);\
         {
 #define ENDFAMILIES\
@@ -74,7 +81,7 @@ int compareRecordKeys(String, String);  // gedcom.c
     GNode *__node = FAMC(person);\
     GNode *family;\
     while (__node) {\
-        family = keyToFamily(__node->value, database);\
+        family = LINKTOFAMILY(__node, database);\
         ASSERT(family);\
         {
 
@@ -90,7 +97,7 @@ int compareRecordKeys(String, String);  // gedcom.c
     GNode *__node = FAMS(person);\
     GNode *family;\
     while (__node) {\
-        family = keyToFamily(__node->value, database);\
+        family = LINKTOFAMILY(__node, database);\
         ASSERT(family);\
         {
 
@@ -102,17 +109,19 @@ int compareRecordKeys(String, String);  // gedcom.c
 }
 
 
-//  FORTAGVALUES -- Iterate a list of nodes looking for a particular tag.
+//  FORTAGVALUES -- Iterate a list of nodes looking for a particular tag. Values are joined with
+//    their CONC and CONT lines; values folded at import are used as they are, without a copy.
 //--------------------------------------------------------------------------------------------------
-#define FORTAGVALUES(root, tagg, node, value)\
+#define FORTAGVALUES(root, tagg, node, val)\
 {\
     GNode *node, *__node = root->child;\
-    String value, __value;\
+    String val, __value;\
     while (__node) {\
         while (__node && strcmp(tagg, __node->tag))\
             __node = __node->sibling;\
         if (__node == null) break;\
-        __value = value = full_value(__node);\
+        __value = isContinuation(__node->child) ? full_value(__node) : null;\
+        val = __value ? __value : __node->value;\
         node = __node;\
         {
 #define ENDTAGVALUES\
@@ -131,7 +140,7 @@ int compareRecordKeys(String, String);  // gedcom.c
     String __key=0;\
     while (__node) {\
         __key = __node->value;\
-        if (!__key || !(husb = keyToPerson(__key, database))) {\
+        if (!__key || !(husb = LINKTOPERSON(__node, database))) {\
             __node = __node->sibling;\
             continue;\
         }\
@@ -153,7 +162,7 @@ int compareRecordKeys(String, String);  // gedcom.c
     String __key = null;\
     while (__node) {\
         __key = __node->value;\
-        if (!__key || !(wife = keyToPerson(__key, database))) {\
+        if (!__key || !(wife = LINKTOPERSON(__node, database))) {\
             __node = __node->sibling;\
             if (__node && nestr(__node->tag, "WIFE")) __node = null;\
                 continue;\
@@ -177,7 +186,7 @@ int compareRecordKeys(String, String);  // gedcom.c
     int num = 0;\
     while (__fnode) {\
         spouse = null;\
-        fam = keyToFamily(__fnode->value, database);\
+        fam = LINKTOFAMILY(__fnode, database);\
         if (__sex == sexMale)\
             spouse = familyToWife(fam, database);\
         else\
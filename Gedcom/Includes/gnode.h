@@ -4,7 +4,7 @@
 //  gnode.h -- GNode datatype. GNodes represent lines in a Gedcom file. GNodes are heap objects.
 //
 //  Created by Thomas Wetmore on 4 November 2022.
-//  Last changed on 19 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef gnode_h
@@ -18,6 +18,7 @@ typedef enum SexType SexType;
 #include "gedcom.h"
 #include "hashtable.h"
 #include "database.h"
+#include "arena.h"
 
 //  GNode -- Data object that holds a Gedcom line in its tree node form. Only root nodes have
 //    key fields, and the @-signs have been removed. Remember this throughout.
@@ -30,6 +31,8 @@ struct GNode {
 	GNode *parent;  // Parent node; all nodes except roots use this field.
 	GNode *child;   // First child none of this node, if any.
 	GNode *sibling; // Next sibling node of this node, if any.
+	GNode *link;    // Root of the record a FAMC, FAMS, HUSB, WIFE or CHIL node refers to, once
+	                //   the database's links are resolved; null until then.
 };
 
 //String fileof = (String) "The file is as positioned at EOF.";
@@ -52,6 +55,11 @@ struct GNode {
 //--------------------------------------------------------------------------------------------------
 GNode* createGNode(String key, String tag, String value, GNode* parent);  // Create a Node.
 void freeGNodes(GNode* node);  // Free a node tree.
+GNode* createGNodeInPlace(String key, String tag, String value, GNode* parent);  // Create a Node that points into a buffer.
+void freeGNodesInPlace(GNode* node);  // Free a node tree created by createGNodeInPlace.
+void freeInternedGNodes(GNode* node);  // Free a node tree whose values are in an intern pool.
+GNode* createGNodeInArena(Arena*, String key, String tag, String value, GNode* parent, bool copy);  // Create a Node in an arena.
+String fix_tag(String tag);  // Return the tag table's copy of a tag.
 int gnodeLevel(GNode* node);  // Return the level of a GNode in its tree.
 
 String gnodeToString(GNode*, int level);
@@ -86,7 +94,10 @@ int countNodes(GNode* node); // Count GNodes in a tree.
 bool isKey(String);
 GNode* findTag(GNode*, String);
 SexType val_to_sex(GNode*);
-String full_value(GNode*);
+String full_value(GNode*);  // Return a node's value joined with its CONC and CONT lines.
+bool isContinuation(GNode*);  // Return whether a node is a CONC or CONT line.
+int foldedValueLength(GNode*);  // Length of a node's value joined with its continuation lines.
+String joinValue(GNode*, String buffer);  // Join a node's value and continuation lines in a buffer.
 
 int numNodeAllocs(void);
 int numNodeFrees(void);
@@ -0,0 +1,52 @@
+//
+//  DeadEnds
+//
+//  linescan.h -- Header file for the vectorized Gedcom line scanner.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#ifndef linescan_h
+#define linescan_h
+
+#include "standard.h"
+
+//  LineScanCode -- Results of scanning a Gedcom line.
+//--------------------------------------------------------------------------------------------------
+typedef enum LineScanCode {
+	ScanOkay = 0,  // The line was scanned.
+	ScanBlank,     // The line is empty or all white space.
+	ScanTooLong,   // The line is longer than MAXLINELEN.
+	ScanNoLevel,   // The line does not begin with a level.
+	ScanIncomplete,// The line ends after the level or inside the key.
+	ScanBadKey,    // The key is @@.
+	ScanNoSpace,   // There is no space between the key and the tag.
+	ScanNoTag      // The line ends after the key.
+} LineScanCode;
+
+//  LineSpan -- Location of a field in a line; start is -1 if the line does not have the field.
+//--------------------------------------------------------------------------------------------------
+typedef struct LineSpan {
+	int start;   // Offset of the field's first character.
+	int length;  // Number of characters in the field.
+} LineSpan;
+
+//  LineSpans -- The fields of a Gedcom line. The key includes its @-signs. The end is the offset
+//    just past the last non-white character of the line.
+//--------------------------------------------------------------------------------------------------
+typedef struct LineSpans {
+	int level;
+	LineSpan key;
+	LineSpan tag;
+	LineSpan value;
+	int end;
+} LineSpans;
+
+//  User interface. scanLine does not change the line; the caller terminates the fields.
+//--------------------------------------------------------------------------------------------------
+LineScanCode scanLine(String line, int length, LineSpans*);  // Find the fields of a line.
+LineScanCode scanNextLine(String start, String limit, LineSpans*, String *next);  // Scan memory.
+String lineScannerName(void);  // Name of the instruction set the scanner was built for.
+
+#endif // linescan_h
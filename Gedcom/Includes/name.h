@@ -4,7 +4,7 @@
 //  name.h -- Header file for Gedcom name functions.
 //
 //  Created by Thomas Wetmore on 7 November 2022.
-//  Last changed on 16 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef name_h
@@ -17,6 +17,22 @@ typedef struct Database Database;
 // Some functions use static dataspace to construct names. MAXNAMELEN is the maximum length.
 //--------------------------------------------------------------------------------------------------
 #define MAXNAMELEN 512
+#define NAMEDISPLAYLEN 68  // Length of the names the name builtin returns.
+
+//  NameForms -- The forms of a Gedcom name that the name functions derive from it, made once so
+//    they aren't derived again each time they are needed. The strings are in the same block of
+//    memory as the structure.
+//--------------------------------------------------------------------------------------------------
+typedef struct NameForms {
+    String source;       // Name the forms were made from; not owned.
+    String surname;      // Surname, as getSurname returns it.
+    String givens;       // Given names, as getGivenNames returns them.
+    String squeezed;     // Given names as a superstring of words, as compareNames compares them.
+    String display;      // manipulateName(source, false, true, NAMEDISPLAYLEN); null if not made.
+    String capsDisplay;  // manipulateName(source, true, true, NAMEDISPLAYLEN); null if not made.
+    int firstInitial;    // First initial, as getFirstInitial returns it.
+    char nameKey[6];     // Name key, as nameToNameKey returns it.
+} NameForms;
 
 // Prototypes of functions defined in names.c.
 //--------------------------------------------------------------------------------------------------
@@ -27,6 +43,9 @@ int getFirstInitial(String name);  // Get the first initial of a Gedcom name.
 String soundex(String surname);  // Get the Soundex code of a Gedcom surname.
 String nameToNameKey(String name);  // Convert a partial or full Gedcom name to a name key.
 int compareNames(String name1, String name2); // Compare two Gedcom names.
+NameForms *createNameForms(String name);  // Make the forms of a Gedcom name.
+void deleteNameForms(NameForms*);  // Delete the forms of a name.
+int compareNameForms(NameForms*, NameForms*);  // Compare two names by their forms.
 String* personKeysFromName(String name, Database*, int* pcount /*[, bool exact]*/);
 String nameString(String name);  // Remove slashes from a name.
 String trimName (String name, int len);  // Trim name to specific length.
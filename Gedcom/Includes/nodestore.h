@@ -0,0 +1,68 @@
+//
+//  DeadEnds
+//
+//  nodestore.h -- Header file for NodeStores, a compact form of Gedcom node trees.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#ifndef nodestore_h
+#define nodestore_h
+
+#include <stdint.h>
+#include "standard.h"
+#include "gnode.h"
+#include "integertable.h"
+#include "arena.h"
+
+//  NodeIndex -- Index of a node in a NodeStore. Index 0 is never used, so it serves as null.
+//--------------------------------------------------------------------------------------------------
+typedef uint32_t NodeIndex;
+#define NONODE 0
+
+//  CompactNode -- A Gedcom line in a NodeStore. The links are indices into the store's node array,
+//    the strings are offsets into its string pool, and the tag is an index into its tag array.
+//    A CompactNode is 24 bytes; a GNode is 48.
+//--------------------------------------------------------------------------------------------------
+typedef struct CompactNode {
+	uint32_t key;       // Offset of the key in the string pool; 0 if none.
+	uint32_t value;     // Offset of the value in the string pool; 0 if none.
+	NodeIndex parent;   // Parent node; NONODE for roots.
+	NodeIndex child;    // First child node, if any.
+	NodeIndex sibling;  // Next sibling node, if any.
+	uint16_t tag;       // Tag ID.
+	uint16_t unused;
+} CompactNode;
+
+//  NodeStore -- Node trees held in contiguous arrays. The nodes of each record are stored in
+//    depth first order, so a record, or all records in order, can be read from memory in order.
+//    Snapshots hold their records in this form.
+//--------------------------------------------------------------------------------------------------
+typedef struct NodeStore {
+	CompactNode *nodes;    // Nodes; nodes[0] is unused.
+	uint32_t numNodes;     // Number of nodes including nodes[0].
+	uint32_t maxNodes;     // Room in the node array.
+	char *strings;         // String pool; offset 0 holds the empty string.
+	uint32_t numBytes;     // Bytes used in the string pool.
+	uint32_t maxBytes;     // Room in the string pool.
+	String *tags;          // Tag strings indexed by tag ID.
+	int numTags;           // Number of tags.
+	int maxTags;           // Room in the tag array.
+	IntegerTable *tagIds;  // Maps tag strings to tag IDs.
+	NodeIndex *roots;      // Roots of the records in the order they were added.
+	uint32_t numRoots;     // Number of records.
+	uint32_t maxRoots;     // Room in the roots array.
+} NodeStore;
+
+//  User interface.
+//--------------------------------------------------------------------------------------------------
+NodeStore *createNodeStore(void);  // Create an empty node store.
+void deleteNodeStore(NodeStore*);  // Delete a node store.
+NodeIndex addToNodeStore(NodeStore*, GNode *root);  // Copy a record into a node store.
+GNode *nodeStoreToGNodes(NodeStore*, NodeIndex root, Arena*);  // Make a GNode tree from a record.
+void releaseNodes(NodeStore*);  // Free the nodes of a node store, keeping its strings.
+bool writeNodeStore(NodeStore*, FILE*);  // Write a node store to a binary file.
+NodeStore *readNodeStore(FILE*);  // Read a node store written by writeNodeStore.
+
+#endif // nodestore_h
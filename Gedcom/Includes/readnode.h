@@ -4,7 +4,7 @@
 //  readnode.h -- Header file for routines and variables that read Gedcom files.
 //
 //  Created by Thomas Wetmore on 17 December 2022.
-//  Last changed on 19 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef readnode_h
@@ -13,6 +13,8 @@
 #include "standard.h"
 #include "gnode.h"
 #include "errors.h"
+#include "mappedfile.h"
+#include "internpool.h"
 
 // Return codes used by functions that extract Gedcom nodes from Gedcom data.
 //--------------------------------------------------------------------------------------------------
@@ -20,10 +22,42 @@
 #define ERROR 0
 #define DONE -1
 
-// Current line number in file being read.
-//extern int fileLine;  // Current line number in file being read.
+//  GedcomReader -- State kept while reading Gedcom records from a file or from memory. A reader
+//    holds the last line read, which is the first line of the next record. If that line could not
+//    be read its error is held instead, and is the error of the next record. Each thread that
+//    reads Gedcom records needs its own reader.
+//--------------------------------------------------------------------------------------------------
+typedef struct GedcomReader {
+	String fileName;  // Name of the file being read, for error messages.
+	FILE *file;       // File being read; null when reading from memory.
+	String cursor;    // Start of the next line when reading from memory.
+	String end;       // End of the memory being read.
+	int line;         // Number of the last line read.
+	int level;        // Level of the last line read.
+	String key;       // Key, if any, of the last line read.
+	String tag;       // Tag of the last line read.
+	String value;     // Value, if any, of the last line read.
+	Error *pending;   // Error of the last line read, if it could not be read; logged by the next read.
+	bool started;     // Whether the first line has been read.
+	bool ateof;       // Whether the end of the file or memory has been reached.
+	bool ownsFile;    // Whether the reader opened the file and must close it.
+	bool copyStrings; // Whether nodes get copies of keys and values; always true for files.
+	Arena *arena;     // Arena the nodes are allocated from; null to use the heap.
+	InternPool *pool; // Pool that values read from a file are interned in; null to copy them.
+	bool foldContinuations;  // Whether CONC and CONT lines are joined into their parents' values.
+	bool skipBadRecords;     // Whether an error skips to the next record instead of stopping.
+	char buffer[MAXLINELEN];  // Line buffer when reading from a file.
+} GedcomReader;
 
 GNode* firstNodeTreeFromFile(FILE*, int *line, ErrorLog*);
 GNode* nextNodeTreeFromFile(FILE*, int *line, ErrorLog*);
+GNode* firstNodeTreeFromMappedFile(MappedFile*, int *line, ErrorLog*);
+GNode* nextNodeTreeFromMappedFile(MappedFile*, int *line, ErrorLog*);
+GedcomReader *createGedcomReader(String fileName);
+GedcomReader *createMappedGedcomReader(MappedFile*);
+void deleteGedcomReader(GedcomReader*);
+void initFileReader(GedcomReader*, FILE*, String fileName);
+void initMemoryReader(GedcomReader*, String start, String end, String fileName);
+GNode* readNodeTree(GedcomReader*, int *line, ErrorLog*);
 
 #endif
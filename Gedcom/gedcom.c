@@ -4,15 +4,24 @@
 //  gedcom.c
 //
 //  Created by Thomas Wetmore on 29 November 2022.
-//  Last changed on 11 October 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "gedcom.h"
 
+//  recordType -- Return the type of a Gedcom record tree.
+//--------------------------------------------------------------------------------------------------
 RecordType recordType(GNode *root)
 {
     ASSERT(root);
-    String tag = root->tag;
+    return tagToRecordType(root->tag);
+}
+
+//  tagToRecordType -- Return the type of a Gedcom record with a given root tag.
+//--------------------------------------------------------------------------------------------------
+RecordType tagToRecordType(String tag)
+{
+    ASSERT(tag);
     if (eqstr(tag, "INDI")) return GRPerson;
     if (eqstr(tag, "FAM"))  return GRFamily;
     if (eqstr(tag, "SOUR")) return GRSource;
@@ -8,8 +8,10 @@
 //    Gedcom-based operations.
 //
 //  Created by Thomas Wetmore on 12 November 2022.
-//  Last changed on 10 November 2023.
+//  Last changed on 17 October 2026.
 
+#include <pthread.h>
+#include <stdatomic.h>
 #include "standard.h"
 #include "gnode.h"
 #include "nodeutils.h"
@@ -22,12 +24,16 @@
 #include "database.h"
 
 //  Tag table. Ensures there are only two allocated strings for every tag. Created the first time
-//    fix_tag is called.
+//    fix_tag is called. Nodes are created on more than one thread during parallel imports, so the
+//    table is guarded by a mutex, and each thread caches the tags it has already looked up.
 static StringTable *tagTable = null;
+static pthread_mutex_t tagTableLock = PTHREAD_MUTEX_INITIALIZER;
+#define TAGCACHESIZE 64
+static _Thread_local String tagCache[TAGCACHESIZE];
 
 //  numNodeAllocs -- Return the number of nodes that have been allocated in the heap. Debugging.
 //--------------------------------------------------------------------------------------------------
-static int nodeAllocs = 0;
+static atomic_int nodeAllocs = 0;
 int numNodeAllocs(void)
 {
 	return nodeAllocs;
@@ -35,7 +41,7 @@ int numNodeAllocs(void)
 
 //  numNodeFrees -- Return the number of nodes that have been freed to the heap. Debugging.
 //--------------------------------------------------------------------------------------------------
-static int nodeFrees = 0;
+static atomic_int nodeFrees = 0;
 int numNodeFrees(void)
 {
 	return nodeFrees;
@@ -53,20 +59,27 @@ static String fixup(String str)
 //    single copy of each one. The tag passed in is usually in a static buffer. The copy of the tag
 //    returned is in the tag table and allocated in the heap.
 //--------------------------------------------------------------------------------------------------
-static String fix_tag(String tag)
+String fix_tag(String tag)
 //  tag -- Return the copy of this tag that is in the tag table.
 {
-	// Need this function to work with or without the table -- a testing issue right now.
-	if (tagTable) return fixString(tagTable, tag);
-	tagTable = createStringTable();
-	return fixString(tagTable, tag);
+	//  Look in this thread's cache first; it holds tags that are already in the table.
+	unsigned int hash = 0;
+	for (String p = tag; *p; p++) hash = hash*31 + (unsigned char) *p;
+	String *cached = &tagCache[hash % TAGCACHESIZE];
+	if (*cached && eqstr(*cached, tag)) return *cached;
+
+	pthread_mutex_lock(&tagTableLock);
+	if (!tagTable) tagTable = createStringTable();
+	String fixed = fixString(tagTable, tag);
+	pthread_mutex_unlock(&tagTableLock);
+	return *cached = fixed;
 }
 
 //  allocGNode -- Allocate a gedcom node. Keep track of the number of allocations.
 //--------------------------------------------------------------------------------------------------
 static GNode* allocGNode(void)
 {
-	nodeAllocs++;
+	atomic_fetch_add_explicit(&nodeAllocs, 1, memory_order_relaxed);
 	return (GNode*) stdalloc(sizeof(GNode));
 }
 
@@ -79,7 +92,7 @@ void freeGNode(GNode* node)
 	ASSERT(node);
 	if (node->key) stdfree(node->key);
 	//if (node->gValue) stdfree(node->gValue);  //  DEBUG: THIS CAUSES A CRASH.
-	nodeFrees++;
+	atomic_fetch_add_explicit(&nodeFrees, 1, memory_order_relaxed);
 	stdfree(node);
 }
 
@@ -98,9 +111,86 @@ GNode* createGNode(String key, String tag, String value, GNode* parent)
 	node->parent = parent;
 	node->child = null;
 	node->sibling = null;
+	node->link = null;
+	return node;
+}
+
+//  createGNodeInPlace -- Create a gedcom node whose key and value point into a buffer owned by
+//    the caller, normally a mapped Gedcom file. Only the tag is put in the tag table.
+//    MNOTE: The key and value are not copied; the buffer must outlive the node.
+//--------------------------------------------------------------------------------------------------
+GNode* createGNodeInPlace(String key, String tag, String value, GNode* parent)
+//  key -- The node's cross reference key, in the caller's buffer.
+//  tag -- The node's tag; it is put in the tag table.
+//  value -- The node's value, in the caller's buffer.
+//  parent -- The node's parent node; only root nodes don't have them.
+{
+	GNode* node = allocGNode();
+	node->key = key;
+	node->tag = fix_tag(tag);
+	node->value = value && *value ? value : null;
+	node->parent = parent;
+	node->child = null;
+	node->sibling = null;
+	node->link = null;
+	return node;
+}
+
+//  createGNodeInArena -- Create a gedcom node in an arena. If copy is true the key and value are
+//    copied into the arena; otherwise they point into a buffer owned by the caller, as with
+//    createGNodeInPlace. Nodes in an arena are never freed one at a time; they are freed with
+//    the arena.
+//--------------------------------------------------------------------------------------------------
+GNode* createGNodeInArena(Arena* arena, String key, String tag, String value, GNode* parent,
+						  bool copy)
+//  arena -- Arena to allocate the node from.
+//  key -- The node's cross reference key; only level 0 GNodes have them.
+//  tag -- The node's tag; it is put in the tag table.
+//  value -- The node's value; some nodes have them, some don't.
+//  parent -- The node's parent node; only root nodes don't have them.
+//  copy -- Whether to copy the key and value into the arena.
+{
+	GNode* node = (GNode*) arenaAlloc(arena, sizeof(GNode));
+	if (value && *value == 0) value = null;
+	node->key = key && copy ? arenaStrsave(arena, key) : key;
+	node->tag = fix_tag(tag);
+	node->value = value && copy ? arenaStrsave(arena, value) : value;
+	node->parent = parent;
+	node->child = null;
+	node->sibling = null;
+	node->link = null;
 	return node;
 }
 
+//  freeGNodesInPlace -- Free all nodes in a tree or forest of nodes built by createGNodeInPlace.
+//    The keys and values are not freed because they belong to the buffer they were read from.
+//--------------------------------------------------------------------------------------------------
+void freeGNodesInPlace(GNode* node)
+//  node -- GNode to recursively free.
+{
+	while (node) {
+		if (node->child) freeGNodesInPlace(node->child);
+		GNode* sib = node->sibling;
+		atomic_fetch_add_explicit(&nodeFrees, 1, memory_order_relaxed);
+		stdfree(node);
+		node = sib;
+	}
+}
+
+//  freeInternedGNodes -- Free all nodes in a tree or forest of nodes whose values were interned.
+//    The keys are freed; the values are not because they belong to the intern pool.
+//--------------------------------------------------------------------------------------------------
+void freeInternedGNodes(GNode* node)
+//  node -- GNode to recursively free.
+{
+	while (node) {
+		if (node->child) freeInternedGNodes(node->child);
+		GNode* sib = node->sibling;
+		freeGNode(node);
+		node = sib;
+	}
+}
+
 //  freeGNodes -- Free all Nodes in a tree or forest of Nodes. This function recurses through all
 //    the Nodes in the tree or forest and calls freeGNode on each.
 //--------------------------------------------------------------------------------------------------
@@ -110,8 +200,7 @@ void freeGNodes(GNode* node)
 	while (node) {
 		// If this Node has children, recurse down a level.
 		if (node->child) freeGNodes(node->child);
-		// TODO: If keys eventually live in a hash table, the next line has to be removed.
-		if (node->key) stdfree(node->key);
+		// The key is freed by freeGNode.
 		if (node->value) stdfree(node->value);
 		// Tags are not freed. They are immortal and live in the tagTable.
 		// Move on the the sibling Node before freeing this Node.
@@ -411,7 +500,7 @@ GNode* fatherNodes (Database* database, GNode* faml)
 	GNode *old = null, *new = null;
 	while (faml) {
 		ASSERT(eqstr("FAMC", faml->tag) || eqstr("FAMS", faml->tag));
-		GNode *fam = keyToFamily(faml->tag, database);
+		GNode *fam = LINKTOFAMILY(faml, database);
 		ASSERT(fam);
 		splitFamily(fam, &refn, &husb, &wife, &chil, &rest);
 		new = union_nodes(old, husb, false, true);
@@ -432,7 +521,7 @@ GNode* mother_nodes (Database *database, GNode *faml)
 	GNode *old = null, *new = null;
 	while (faml) {
 		ASSERT(eqstr("FAMC", faml->tag) || eqstr("FAMS", faml->tag));
-		GNode *fam = keyToFamily(faml->tag, database);
+		GNode *fam = LINKTOFAMILY(faml, database);
 		ASSERT(fam);
 		splitFamily(fam, &refn, &husb, &wife, &chil, &rest);
 		new = union_nodes(old, wife, false, true);
@@ -455,7 +544,7 @@ GNode* children_nodes(Database *database, GNode *faml)
 	GNode *old = null, *new = null;
 	while (faml) {
 		ASSERT(eqstr("FAMC", faml->tag) || eqstr("FAMS", faml->tag));
-		GNode *fam = keyToFamily(faml->tag, database);
+		GNode *fam = LINKTOFAMILY(faml, database);
 		ASSERT(fam);
 		splitFamily(fam, &refn, &husb, &wife, &chil, &rest);
 		new = union_nodes(old, chil, false, true);
@@ -477,7 +566,7 @@ GNode* parents_nodes(Database *database, GNode* family)
 	GNode *old = null, *new = null;
 	while (family) {
 		ASSERT(eqstr("FAMC", family->tag) || eqstr("FAMS", family->tag));
-		GNode *fam = keyToFamily(family->value, database);
+		GNode *fam = LINKTOFAMILY(family, database);
 		ASSERT(fam);
 		splitFamily(fam, &refn, &husb, &wife, &chil, &rest);
 		new = union_nodes(old, husb, false, true);
@@ -558,40 +647,63 @@ SexType val_to_sex (GNode* node)
 	return sexUnknown;
 }
 
-// full_value -- Return value of node, with CONT lines. This has never worked according to Gedcom
-// specifications.
+//  isContinuation -- Return whether a node is a CONC or CONT line that continues the value of
+//    its parent. Continuation lines with children of their own are not treated as continuations.
 //--------------------------------------------------------------------------------------------------
-String full_value(GNode* node)
-//Node node;
+bool isContinuation(GNode* node)
 {
-	GNode* cont;
-	int len = 0;
-	String p, q, str;
-	if (!node) return null;
-	if ((p = node->value)) len += strlen(p) + 1;
-	cont = node->child;
-	while (cont && !strcmp("CONT", cont->tag)) {
-		if ((p = cont->value))
-			len += strlen(p) + 1;
-		else
-			len++;
-		cont = cont->sibling;
+	if (!node || node->child) return false;
+	return eqstr(node->tag, "CONC") || eqstr(node->tag, "CONT");
+}
+
+//  foldedValueLength -- Return the length of the value of a node joined with the values of its
+//    leading CONC and CONT children. Each CONT child adds a newline before its value.
+//--------------------------------------------------------------------------------------------------
+int foldedValueLength(GNode* node)
+{
+	int length = node->value ? (int) strlen(node->value) : 0;
+	for (GNode *cont = node->child; isContinuation(cont); cont = cont->sibling) {
+		if (cont->value) length += strlen(cont->value);
+		if (cont->tag[3] == 'T') length++;
 	}
-	if (len == 0) return null;
-	str = p = stdalloc(len + 1);
-	if ((q = node->value)) {
-		sprintf(p, "%s\n", q);
-		p += strlen(p);
+	return length;
+}
+
+//  joinValue -- Write the value of a node joined with the values of its leading CONC and CONT
+//    children into a buffer of foldedValueLength + 1 characters. A CONT child starts a new line
+//    of the value; a CONC child continues the line. The pieces are moved in order with memmove,
+//    so the buffer may overlap the values as long as each piece is written at or before the place
+//    it is read from, as when values that point into a buffer of Gedcom text are joined in place.
+//    Returns the buffer.
+//--------------------------------------------------------------------------------------------------
+String joinValue(GNode* node, String buffer)
+//  node -- Node whose value and continuation values are joined.
+//  buffer -- Where to put the joined value.
+{
+	String p = buffer;
+	size_t length;
+	if (node->value) {
+		length = strlen(node->value);
+		memmove(p, node->value, length);
+		p += length;
 	}
-	cont = node->child;
-	while (cont && !strcmp("CONT", cont->tag)) {
-		if ((q = cont->value))
-			sprintf(p, "%s\n", q);
-		else
-			sprintf(p, "\n");
-		p += strlen(p);
-		cont = cont->sibling;
+	for (GNode *cont = node->child; isContinuation(cont); cont = cont->sibling) {
+		if (cont->tag[3] == 'T') *p++ = '\n';
+		if (cont->value) {
+			length = strlen(cont->value);
+			memmove(p, cont->value, length);
+			p += length;
+		}
 	}
-	*(p - 1) = 0;
-	return str;
+	*p = 0;
+	return buffer;
+}
+
+//  full_value -- Return the value of a node joined with its CONC and CONT lines, in the heap. The
+//    caller frees it. Returns null if the node has no value and no continuation lines.
+//--------------------------------------------------------------------------------------------------
+String full_value(GNode* node)
+{
+	if (!node || (!node->value && !isContinuation(node->child))) return null;
+	return joinValue(node, (String) stdalloc(foldedValueLength(node) + 1));
 }
@@ -4,7 +4,7 @@
 //  lineage.c -- Operations on Gedcom nodes based on genealogical relationsips and properties.
 //
 //  Created by Thomas Wetmore on 17 February 2023.
-//  Last changed on 14 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "lineage.h"
@@ -46,7 +46,7 @@ GNode* personToPreviousSibling(GNode* indi, Database *database)
 	while (node && eqstr("CHIL", node->tag)) {
 		if (eqstr(indi->key, node->value)) {  // Found the person as a child.
 			if (!prev) return null;  // There is no previous sibling.
-			return keyToPerson(prev->value, database);  // There is a previous sibling.
+			return LINKTOPERSON(prev, database);  // There is a previous sibling.
 		}
 		prev = node;
 		node = node->sibling;  //  Move to the next CHIL node.
@@ -75,7 +75,7 @@ GNode* personToNextSibling(GNode* indi, Database* database)
 	if (!node) return null;
 	node = node->sibling;
 	if (!node || nestr("CHIL", node->tag)) return null;
-	return keyToPerson(node->value, database);
+	return LINKTOPERSON(node, database);
 }
 
 //  familyToHusband -- Return the first husband of a family. This is the first HUSB in the
@@ -91,7 +91,7 @@ GNode* familyToHusband(GNode* node, Database *database)
 	if (debugging) {
 		printf("familyToHusband found person %s\n", node->value);
 	}
-	return keyToPerson(node->value, database);
+	return LINKTOPERSON(node, database);
 }
 
 //  familyToWife -- Return the first wife of a family. This is the first WIFE in the FAM record.
@@ -106,7 +106,7 @@ GNode *familyToWife(GNode* node, Database *database)
 	if (debugging) {
 		printf("familyToWife found person %s\n", node->value);
 	}
-	return keyToPerson(node->value, database);
+	return LINKTOPERSON(node, database);
 }
 
 //  Return the first spouse with a given sex from a family.
@@ -140,7 +140,7 @@ GNode* familyToFirstChild(GNode* node, Database *database)
 {
 	if (!node) return null;
 	if (!(node = CHIL(node))) return null;
-	return keyToPerson(node->value, database);
+	return LINKTOPERSON(node, database);
 }
 
 //  familyToLastChild -- Return the last child of a family if any.
@@ -155,7 +155,7 @@ GNode* familyToLastChild(GNode* node, Database *database)
 		if (eqstr(node->tag, "CHIL")) chil = node;
 		node = node->sibling;
 	}
-	return keyToPerson(chil->value, database);
+	return LINKTOPERSON(chil, database);
 }
 
 //  numberOfSpouses -- Returns the number of spouses of a person.
@@ -192,7 +192,7 @@ GNode* personToFamilyAsChild(GNode* person, Database* database)
 {
 	if (!person) return null;
 	if (!(person = FAMC(person))) return null;
-	return keyToFamily(person->value, database);
+	return LINKTOFAMILY(person, database);
 }
 
 //  personToName -- Return the name of a person. From the value of the first NAME node in the
@@ -0,0 +1,255 @@
+//
+//  DeadEnds
+//
+//  linescan.c -- Vectorized scanner that finds the fields of Gedcom lines. The scanner compares
+//    a block of characters at a time against the newline, the white space characters and the
+//    @-sign, turning the block into bit masks whose lowest set bits are the positions of the line
+//    and field boundaries. Most lines fit in one block, so one load finds all their fields.
+//    Blocks are 32 characters with AVX2 and 16 with SSE2. On Gedcom lines, which are short, the
+//    scalar loop has measured faster than both, so it is the default; define LINESCANSIMD to
+//    build a block version, with -mavx2 (or -march=native) for AVX2.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+#include "linescan.h"
+
+#if defined(LINESCANSIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define BLOCKSIZE 32
+typedef __m256i Block;
+#define loadBlock(p)   _mm256_loadu_si256((const __m256i*) (p))
+#define equals(b, c)   _mm256_cmpeq_epi8((b), _mm256_set1_epi8(c))
+#define either(a, b)   _mm256_or_si256((a), (b))
+#define toMask(v)      ((uint32_t) _mm256_movemask_epi8(v))
+#define ALLBITS        0xffffffffu
+static String scannerName = "AVX2";
+#elif defined(LINESCANSIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define BLOCKSIZE 16
+typedef __m128i Block;
+#define loadBlock(p)   _mm_loadu_si128((const __m128i*) (p))
+#define equals(b, c)   _mm_cmpeq_epi8((b), _mm_set1_epi8(c))
+#define either(a, b)   _mm_or_si128((a), (b))
+#define toMask(v)      ((uint32_t) _mm_movemask_epi8(v))
+#define ALLBITS        0xffffu
+static String scannerName = "SSE2";
+#else
+static String scannerName = "scalar";
+#endif
+
+//  MaskKind -- The kinds of characters the scanner looks for.
+//--------------------------------------------------------------------------------------------------
+typedef enum MaskKind {
+	WhiteKind, NonWhiteKind, AtKind
+} MaskKind;
+
+//  Scanner -- State of a scan of one line. With blocks, the masks of the block most recently
+//    loaded are kept, so the searches for the fields, which move forward through the line, load
+//    each block once. Blocks are only loaded where limit leaves room for a full one; the
+//    characters nearer the limit are scanned one at a time.
+//--------------------------------------------------------------------------------------------------
+typedef struct Scanner {
+	String line;       // Line being scanned.
+	int end;           // Offset just past the last non-white character.
+#ifdef BLOCKSIZE
+	int limit;         // Number of characters from the start of the line that may be read.
+	int base;          // Offset of the block the masks are for; -BLOCKSIZE if none.
+	uint32_t valid;    // Mask of the positions in the block that are in the line.
+	uint32_t white;    // Mask of the white space in the block.
+	uint32_t at;       // Mask of the @-signs in the block.
+	uint32_t newline;  // Mask of the newlines in the block.
+#endif
+} Scanner;
+
+//  isWhite -- Inline version of iswhite.
+//--------------------------------------------------------------------------------------------------
+static inline bool isWhite(int c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+//  findNextScalar -- Return the offset of the first character of a kind in a line at or after
+//    pos, or end if there is none, looking at one character at a time.
+//--------------------------------------------------------------------------------------------------
+static inline int findNextScalar(String line, int pos, int end, MaskKind kind)
+{
+	switch (kind) {
+	case WhiteKind: while (pos < end && !isWhite(line[pos])) pos++; break;
+	case NonWhiteKind: while (pos < end && isWhite(line[pos])) pos++; break;
+	case AtKind: while (pos < end && line[pos] != '@') pos++; break;
+	}
+	return pos;
+}
+
+#ifdef BLOCKSIZE
+//  loadMasks -- Load the block that starts at base and find its masks. The caller makes sure the
+//    whole block is within the limit. The positions at or past the end of the line are masked off.
+//--------------------------------------------------------------------------------------------------
+static inline void loadMasks(Scanner *scanner, int base)
+//  scanner -- Scanner whose masks are loaded.
+//  base -- Offset of the block in the line.
+{
+	Block block = loadBlock(scanner->line + base);
+	int count = scanner->end - base;
+	scanner->base = base;
+	scanner->valid = count >= BLOCKSIZE ? ALLBITS : (1u << count) - 1;
+	Block newline = equals(block, '\n');
+	scanner->newline = toMask(newline);
+	scanner->white = toMask(either(either(equals(block, ' '), equals(block, '\t')),
+								   either(newline, equals(block, '\r'))));
+	scanner->at = toMask(equals(block, '@'));
+}
+#endif
+
+//  findNext -- Return the offset of the first character of a kind in a line at or after pos,
+//    or the end of the line if there is none.
+//--------------------------------------------------------------------------------------------------
+static inline int findNext(Scanner *scanner, int pos, MaskKind kind)
+//  scanner -- Scanner of the line.
+//  pos -- Offset to start at.
+//  kind -- Kind of character to find.
+{
+	int end = scanner->end;
+#ifdef BLOCKSIZE
+	while (pos < end) {
+		if (pos >= scanner->base + BLOCKSIZE) {
+			if (scanner->limit - pos < BLOCKSIZE) return findNextScalar(scanner->line, pos, end, kind);
+			loadMasks(scanner, pos);
+		}
+		uint32_t mask = kind == AtKind ? scanner->at : scanner->white;
+		if (kind == NonWhiteKind) mask = ~mask;
+		mask = (mask & scanner->valid) >> (pos - scanner->base);
+		if (mask) return pos + __builtin_ctz(mask);
+		pos = scanner->base + BLOCKSIZE;
+	}
+	return end;
+#else
+	return findNextScalar(scanner->line, pos, end, kind);
+#endif
+}
+
+//  skipWhite -- Return the offset of the first non-white character at or after pos. Most fields
+//    are separated by a single space, so the next character is checked before scanning.
+//--------------------------------------------------------------------------------------------------
+static inline int skipWhite(Scanner *scanner, int pos)
+{
+	if (pos < scanner->end && !isWhite(scanner->line[pos])) return pos;
+	return findNext(scanner, pos, NonWhiteKind);
+}
+
+//  scanFields -- Find the level, key, tag and value of a line whose end has been found. White
+//    space before the level is ignored, and the key and tag may be separated by more than one
+//    space.
+//--------------------------------------------------------------------------------------------------
+static inline LineScanCode scanFields(Scanner *scanner, LineSpans *spans)
+//  scanner -- Scanner of the line.
+//  spans -- (out) Level and the locations of the fields.
+{
+	String line = scanner->line;
+	int end = scanner->end;
+	spans->end = end;
+	if (end == 0) return ScanBlank;
+	if (end > MAXLINELEN) return ScanTooLong;
+
+	//  Get the level.
+	int pos = skipWhite(scanner, 0);
+	if (line[pos] < '0' || line[pos] > '9') return ScanNoLevel;
+	int level = line[pos++] - '0';
+	while (pos < end && line[pos] >= '0' && line[pos] <= '9') level = level*10 + line[pos++] - '0';
+	spans->level = level;
+	pos = skipWhite(scanner, pos);
+	if (pos == end) return ScanIncomplete;
+
+	//  Get the key, if any, including its @-signs; it must be followed by a space.
+	if (line[pos] == '@') {
+		int start = pos++;
+		if (pos < end && line[pos] == '@') return ScanBadKey;
+		pos = findNext(scanner, pos, AtKind);
+		if (pos == end) return ScanIncomplete;
+		if (++pos == end || line[pos] != ' ') return ScanNoSpace;
+		spans->key = (LineSpan) {start, pos - start};
+		pos = skipWhite(scanner, pos + 1);
+		if (pos == end) return ScanNoTag;
+	}
+
+	//  Get the tag and the value, if any.
+	int tagEnd = findNext(scanner, pos, WhiteKind);
+	spans->tag = (LineSpan) {pos, tagEnd - pos};
+	if (tagEnd == end) return ScanOkay;
+	pos = skipWhite(scanner, tagEnd + 1);
+	spans->value = (LineSpan) {pos, end - pos};
+	return ScanOkay;
+}
+
+//  scanLine -- Find the fields of a line whose length is known. White space after the value is
+//    ignored. The line is not changed; the caller uses the spans to terminate the fields.
+//--------------------------------------------------------------------------------------------------
+LineScanCode scanLine(String line, int length, LineSpans *spans)
+//  line -- Line to scan; it need not be terminated.
+//  length -- Length of the line, including any trailing white space.
+//  spans -- (out) Level and the locations of the fields.
+{
+	spans->level = 0;
+	spans->key = spans->tag = spans->value = (LineSpan) {-1, 0};
+	int end = length;
+	while (end > 0 && isWhite(line[end - 1])) end--;
+	Scanner scanner = {.line = line, .end = end};
+#ifdef BLOCKSIZE
+	scanner.limit = length;
+	scanner.base = -BLOCKSIZE;
+#endif
+	return scanFields(&scanner, spans);
+}
+
+//  scanNextLine -- Find the end and the fields of the next line in memory. The first block of
+//    the line is searched for the newline and the fields at the same time; only lines longer than
+//    a block need a second search for the newline. The last few characters of the memory, where a
+//    block would not fit, are scanned one at a time.
+//--------------------------------------------------------------------------------------------------
+LineScanCode scanNextLine(String start, String limit, LineSpans *spans, String *next)
+//  start -- Start of the line.
+//  limit -- End of the memory; start must be less than limit.
+//  spans -- (out) Level and the locations of the fields.
+//  next -- (out) Start of the following line, or limit if this is the last line.
+{
+#ifdef BLOCKSIZE
+	ptrdiff_t available = limit - start;
+	if (available >= BLOCKSIZE) {
+		spans->level = 0;
+		spans->key = spans->tag = spans->value = (LineSpan) {-1, 0};
+		Scanner scanner = {.line = start, .end = BLOCKSIZE};
+		scanner.limit = available < INT_MAX ? (int) available : INT_MAX;
+		loadMasks(&scanner, 0);
+		uint32_t newlines = scanner.newline;
+		ptrdiff_t length;
+		if (newlines) {
+			length = __builtin_ctz(newlines);
+			*next = start + length + 1;
+		} else {
+			String newline = memchr(start + BLOCKSIZE, '\n', available - BLOCKSIZE);
+			*next = newline ? newline + 1 : limit;
+			length = (newline ? newline : limit) - start;
+		}
+		while (length > 0 && isWhite(start[length - 1])) length--;
+		if (length > MAXLINELEN) return ScanTooLong;
+		scanner.end = (int) length;
+		if (length < BLOCKSIZE) scanner.valid = (1u << length) - 1;
+		return scanFields(&scanner, spans);
+	}
+#endif
+	String newline = memchr(start, '\n', limit - start);
+	*next = newline ? newline + 1 : limit;
+	return scanLine(start, (int) ((newline ? newline : limit) - start), spans);
+}
+
+//  lineScannerName -- Return the name of the instruction set the scanner uses.
+//--------------------------------------------------------------------------------------------------
+String lineScannerName(void)
+{
+	return scannerName;
+}
@@ -2,10 +2,11 @@
 //  DeadEnds
 //
 //  name.c -- Functions that deal with Gedcom names. Several functions return pointers to
-//    static memory. Callers of those functions must be aware of the consequences.
+//    static memory. Callers of those functions must be aware of the consequences. Each thread
+//    has its own static memory, so names can be indexed by several threads at once.
 //
 //  Created by Thomas Wetmore on 7 November 2022.
-//  Last changed on 16 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "standard.h"
@@ -13,7 +14,7 @@
 #include "gnode.h"
 #include "nameindex.h"
 
-static int old = 0;
+static _Thread_local int old = 0;  // Previous Soundex code; used by codeOf.
 
 // Static functions used in this file.
 static int codeOf(int letter);
@@ -23,17 +24,19 @@ static void nameToParts(String name, String *parts);
 static void squeeze(String string, String super);
 static String nextPiece(String name);
 static void cmpsqueeze (String in, String out);
+static int compareSqueezed(String, String);
 //static String nameString (String);
 static String nameSurnameFirst(String);
 
 //  nameToNameKey - Convert Gedcom name or partial name to a name key. A name key is six
 //    characters and consists of the name's first initial and the soundex of the surname.
-//    MNOTE: This function returns the key in static data space.
+//    MNOTE: This function returns the key in static data space. Each thread has its own, as it
+//    does for getSurname and soundex, so names can be indexed by several threads at once.
 //--------------------------------------------------------------------------------------------------
 String nameToNameKey(String name)
 //  name -- Gedcom name to convert to a name key.
 {
-    static char key[6];
+    static _Thread_local char key[6];
 
     char finitial = getFirstInitial(name);
     String sdex = soundex(getSurname(name));
@@ -55,8 +58,8 @@ String getSurname(String name)
 {
     int c;
 
-    static char buffer[NBUFFERS][MAXLINELEN+1];
-    static int dex = 0;
+    static _Thread_local char buffer[NBUFFERS][MAXLINELEN+1];
+    static _Thread_local int dex = 0;
     String p, surname;
     if (++dex > NBUFFERS-1) dex = 0;
     p = surname = buffer[dex];
@@ -98,7 +101,7 @@ int getFirstInitial(String name)
 String soundex(String name)
 //  name -- Surname to find the Soundex code for.
 {
-    static char scratch[MAXNAMELEN];
+    static _Thread_local char scratch[MAXNAMELEN];
 
     int c, j;
     if (!name || strlen(name) > MAXNAMELEN || !strcmp(name, "____"))
@@ -225,7 +228,6 @@ String key;    /* person's INDI key */
 
 
 //  exactMatch -- Check if a partial name is contained within a complete name.
-//    TODO: This function is not called from anywhere.
 //--------------------------------------------------------------------------------------------------
 bool exactMatch(String partial, String complete)
 //  partial -- Partial name.
@@ -299,8 +301,10 @@ static void squeeze(String in, String out)
     }
 }
 
-//  personKeysFromName -- Find all persons with a name that matches the parameter name. Returns
-//    the list of their keys.
+//  personKeysFromName -- Find all persons with a name that matches the parameter name. A name
+//    matches if each of its words is a partial match of a word of a person's name, in order, as
+//    exactMatch checks. Returns an array of the keys of the persons, which belongs to this
+//    function and is reused by the next call; callers should copy it if they need to keep it.
 //
 //  TODO: THIS USED TO ALSO FIND PERSONS WHO MATCHED A KEY.
 //--------------------------------------------------------------------------------------------------
@@ -309,63 +313,57 @@ String* personKeysFromName(String name, Database *database, int* pcount)
 //  database -- Database.
 //  pcount -- (out) Number of Persons with matching names.
 {
-    //  This function uses listOfKeys as a state variable that holds the most recent list of keys.
-    //    Callers should copy this list if they need a persistent copy.
-    static bool first = true;
-    static int count = 0;
-    static List listOfKeys;  //  NOTE: listOfKeys is not on the heap.
-
-    ASSERT(name);
-
-    // Create the state variables on the first call.
-    if (first) {
-        List *pListOfKeys = createList(null, null, null);
-        memcpy(&listOfKeys, pListOfKeys, sizeof(List));
-        stdfree(pListOfKeys);
-        first = false;
+    static String *keys = null;  //  Keys of the most recent search.
+    static int maxKeys = 0;
+
+    ASSERT(name && database && pcount);
+    *pcount = 0;
+
+    //  Get the record ids of the persons with names that share the name key of the input name.
+    //  The ids are in the index -- no memory obligations.
+    int numIds;
+    RecordId *ids = searchNameIndex(database->nameIndex, name, &numIds);
+    if (numIds == 0) return null;
+    if (numIds > maxKeys) {
+        if (keys) stdfree(keys);
+        maxKeys = numIds;
+        keys = (String*) stdalloc(maxKeys*sizeof(String));
     }
 
-    //  Get the record keys of the persons with names that share the name key of the input name.
-    //  The set of keys is in the index -- no memory obligations.
-    Set *keySet = searchNameIndex(database->nameIndex, name);
-
-    // If there are no keys there is nothing to do.
-    if (!keySet || lengthSet(keySet) == 0) return null;
-
-    // Empty the state variable list.
-    deleteList(&listOfKeys);
-
-    // Loop through the set of keys looking for persons with names that match the input name.
-    List *list = keySet->list;
-    String* keys = (String*) list->data;
-    count = 0;
-    for (int i = 0, n = list->length; i < n; i++) {
-        GNode* person = keyToPerson(keys[i], database);
+    // Loop through the persons looking for ones with names that match the input name.
+    for (int i = 0; i < numIds; i++) {
+        GNode* person = recordIdToRecord(ids[i], database);
         for (GNode* node = NAME(person); node && eqstr(node->tag, "NAME"); node = node->sibling) {
-            if (!compareNames(name, node->value)) continue;
-            appendListElement(&listOfKeys, (Word) keys[i]);
+            if (!node->value || !exactMatch(name, node->value)) continue;
+            keys[(*pcount)++] = recordIdToKey(ids[i], database);
             break;  // Don't care if other names of this person also match.
         }
     }
-    *pcount = count;
-    return (String*) listOfKeys.data;
+    return *pcount ? keys : null;
 }
 
-//  compareNames -- Compare two Gedcom names. Return their relationship.
+//  compareNames -- Compare two Gedcom names. Return their relationship. Names are compared by
+//    surname, then first initial, then given names.
 //--------------------------------------------------------------------------------------------------
 int compareNames(String name1, String name2)
 //  name1, name2 -- The two names to compare.
 {
     char sqz1[MAXNAMELEN], sqz2[MAXNAMELEN];
-    String p1 = sqz1, p2 = sqz2;
     int r = strcmp(getSurname(name1), getSurname(name2));
     if (r) return r;
     r = getFirstInitial(name1) - getFirstInitial(name2);
     if (r) return r;
-    cmpsqueeze(name1, p1);
-    cmpsqueeze(name2, p2);
+    cmpsqueeze(name1, sqz1);
+    cmpsqueeze(name2, sqz2);
+    return compareSqueezed(sqz1, sqz2);
+}
+
+//  compareSqueezed -- Compare two superstrings of given names, word by word.
+//--------------------------------------------------------------------------------------------------
+static int compareSqueezed(String p1, String p2)
+{
     while (*p1 && *p2) {
-        r = strcmp(p1, p2);
+        int r = strcmp(p1, p2);
         if (r) return r;
         p1 += strlen(p1) + 1;
         p2 += strlen(p2) + 1;
@@ -375,6 +373,77 @@ int compareNames(String name1, String name2)
     return 0;
 }
 
+//  createNameForms -- Make the forms of a Gedcom name that the name functions and builtins derive
+//    from it. The structure and its strings are one block of memory. The display forms are only
+//    made for names short enough that manipulateName returns them untrimmed.
+//--------------------------------------------------------------------------------------------------
+NameForms *createNameForms(String name)
+//  name -- Gedcom name; it is not copied and must live as long as the forms.
+{
+    ASSERT(name);
+    char copy[MAXNAMELEN - 1];
+    String source = name;
+    if (strlen(name) > MAXNAMELEN - 2) {  // The squeezed and given names must fit their buffers.
+        strncpy(copy, name, MAXNAMELEN - 2);
+        copy[MAXNAMELEN - 2] = 0;
+        name = copy;
+    }
+    char nameKey[6], squeezed[MAXNAMELEN];
+    char display[NAMEDISPLAYLEN + 1] = "", capsDisplay[NAMEDISPLAYLEN + 1] = "";
+    memcpy(nameKey, nameToNameKey(name), 6);
+    bool displayed = *name && strlen(name) <= NAMEDISPLAYLEN;
+    if (displayed) {
+        strcpy(display, manipulateName(name, false, true, NAMEDISPLAYLEN));
+        strcpy(capsDisplay, manipulateName(name, true, true, NAMEDISPLAYLEN));
+    }
+    cmpsqueeze(name, squeezed);
+    int squeezedLength = 0;
+    while (squeezed[squeezedLength]) squeezedLength += (int) strlen(squeezed + squeezedLength) + 1;
+    String surname = getSurname(name);
+    String givens = getGivenNames(name);
+
+    //  Copy the forms into one block.
+    size_t size = sizeof(NameForms) + strlen(surname) + strlen(givens) + squeezedLength + 3;
+    if (displayed) size += strlen(display) + strlen(capsDisplay) + 2;
+    NameForms *forms = (NameForms*) stdalloc(size);
+    String p = (String) (forms + 1);
+    forms->source = source;
+    forms->surname = strcpy(p, surname);
+    p += strlen(p) + 1;
+    forms->givens = strcpy(p, givens);
+    p += strlen(p) + 1;
+    forms->squeezed = memcpy(p, squeezed, squeezedLength + 1);
+    p += squeezedLength + 1;
+    forms->display = forms->capsDisplay = null;
+    if (displayed) {
+        forms->display = strcpy(p, display);
+        p += strlen(p) + 1;
+        forms->capsDisplay = strcpy(p, capsDisplay);
+    }
+    forms->firstInitial = getFirstInitial(name);
+    memcpy(forms->nameKey, nameKey, 6);
+    return forms;
+}
+
+//  deleteNameForms -- Delete the forms of a name.
+//--------------------------------------------------------------------------------------------------
+void deleteNameForms(NameForms *forms)
+{
+    stdfree(forms);
+}
+
+//  compareNameForms -- Compare two names by their forms, as compareNames compares the names.
+//--------------------------------------------------------------------------------------------------
+int compareNameForms(NameForms *forms1, NameForms *forms2)
+//  forms1, forms2 -- Forms of the two names to compare.
+{
+    int r = strcmp(forms1->surname, forms2->surname);
+    if (r) return r;
+    r = forms1->firstInitial - forms2->firstInitial;
+    if (r) return r;
+    return compareSqueezed(forms1->squeezed, forms2->squeezed);
+}
+
 // cmpsqueeze -- Squeeze a Gedcom name to a superstring of given names.
 //--------------------------------------------------------------------------------------------------
 static void cmpsqueeze (String in, String out)
@@ -403,7 +472,7 @@ String getGivenNames (String name)
 {
     int c;
     // Buffer to hold the given names.
-    static char scratch[MAXNAMELEN+1];
+    static _Thread_local char scratch[MAXNAMELEN+1];
     String out = scratch;
     // Scan the Gedcom name for its 'pieces'.
     while ((name = nextPiece(name))) {  // Get the next piece of the Gedcom name.
@@ -411,7 +480,7 @@ String getGivenNames (String name)
             // If have reached the end of the Gedcom name.
             if ((c = *name++) == 0) {
                 // If the last character in the out buffer is a space backup a character.
-                if (*(out - 1) == ' ') --out;
+                if (out > scratch && *(out - 1) == ' ') --out;
                 // Add null at the end of the out buffer and return it.
                 *out = 0;
                 return scratch;
@@ -427,7 +496,7 @@ String getGivenNames (String name)
             *out++ = c;
         }
     }
-    if (*(out - 1) == ' ') --out;
+    if (out > scratch && *(out - 1) == ' ') --out;
     *out = 0;
     return scratch;
 }
@@ -496,7 +565,7 @@ static void nameToParts(String name, String* parts)
 //  name -- Gedcom name.
 //  parts --
 {
-    static char scratch[MAXNAMELEN+1];
+    static _Thread_local char scratch[MAXNAMELEN+1];
     String p = scratch;
     int c, i = 0;
     ASSERT(strlen(name) <= MAXNAMELEN);
@@ -532,7 +601,7 @@ static String partsToName(String* parts)
 //  parts -- Array of strings representing a name.
 {
     int i;
-    static char scratch[MAXNAMELEN+1];
+    static _Thread_local char scratch[MAXNAMELEN+1];
     String p = scratch;
     for (i = 0; i < MAXPARTS; i++) {
         if (!parts[i]) continue;
@@ -553,7 +622,7 @@ static String partsToName(String* parts)
 String upsurname(String name)
 //  name -- Gedcom name (with surname between slashes).
 {
-    static char scratch[MAXNAMELEN+1];
+    static _Thread_local char scratch[MAXNAMELEN+1];
     String p = scratch;
     int c;
     while ((c = *p++ = *name++) && c != '/') ;
@@ -589,7 +658,7 @@ String manipulateName (String name, bool caps, bool reg, int len)
 String nameString(String name)
 //  name -- Gedcom format name.
 {
-    static char scratch[MAXNAMELEN+1];
+    static _Thread_local char scratch[MAXNAMELEN+1];
     String p = scratch;
     ASSERT(strlen(name) <= MAXNAMELEN);
     while (*name) {
@@ -607,7 +676,7 @@ String nameString(String name)
 static String nameSurnameFirst(String name)
 //  name -- Gedcom format name.
 {
-    static char scratch[MAXNAMELEN+1];
+    static _Thread_local char scratch[MAXNAMELEN+1];
     String p = scratch;
     ASSERT(strlen(name) <= MAXNAMELEN);
     strcpy(p, getSurname(name));
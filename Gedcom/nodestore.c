@@ -0,0 +1,323 @@
+//
+//  DeadEnds
+//
+//  nodestore.c -- Functions that implement NodeStores. A NodeStore holds Gedcom records in a
+//    compact form: all nodes in one array, linked by 32-bit indices, with their strings in one
+//    pool and their tags replaced by small integer IDs. Snapshots are written and read in this
+//    form; the records are made into GNode trees when a snapshot is loaded.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#include "nodestore.h"
+
+#define INITIAL_NODES 4096
+#define INITIAL_BYTES 65536
+#define INITIAL_TAGS 64
+#define INITIAL_ROOTS 1024
+
+//  growArray -- Double the size of an array, copying its contents. Returns the new array.
+//--------------------------------------------------------------------------------------------------
+static Word growArray(Word array, size_t used, size_t newSize)
+{
+	Word newArray = stdalloc(newSize);
+	if (used) memcpy(newArray, array, used);
+	stdfree(array);
+	return newArray;
+}
+
+//  Accessors of the fields of the nodes in a store.
+//--------------------------------------------------------------------------------------------------
+#define nsChild(store, n)   ((store)->nodes[(n)].child)
+#define nsSibling(store, n) ((store)->nodes[(n)].sibling)
+#define nsTag(store, n)     ((store)->tags[(store)->nodes[(n)].tag])
+#define nsString(store, offset) ((offset) ? (store)->strings + (offset) : null)
+#define nsKey(store, n)     nsString(store, (store)->nodes[(n)].key)
+#define nsValue(store, n)   nsString(store, (store)->nodes[(n)].value)
+
+//  createNodeStore -- Create an empty node store.
+//--------------------------------------------------------------------------------------------------
+NodeStore *createNodeStore(void)
+{
+	NodeStore *store = (NodeStore*) stdalloc(sizeof(NodeStore));
+	store->maxNodes = INITIAL_NODES;
+	store->nodes = (CompactNode*) stdalloc(store->maxNodes*sizeof(CompactNode));
+	memset(store->nodes, 0, sizeof(CompactNode));
+	store->numNodes = 1;  // nodes[0] stands for null.
+	store->maxBytes = INITIAL_BYTES;
+	store->strings = stdalloc(store->maxBytes);
+	store->strings[0] = 0;
+	store->numBytes = 1;  // Offset 0 stands for null.
+	store->maxTags = INITIAL_TAGS;
+	store->tags = (String*) stdalloc(store->maxTags*sizeof(String));
+	store->numTags = 0;
+	store->tagIds = createIntegerTable();
+	store->maxRoots = INITIAL_ROOTS;
+	store->roots = (NodeIndex*) stdalloc(store->maxRoots*sizeof(NodeIndex));
+	store->numRoots = 0;
+	return store;
+}
+
+//  deleteNodeStore -- Delete a node store. GNode trees made from it with nodeStoreToGNodes point
+//    into its string pool and must not be used afterwards.
+//--------------------------------------------------------------------------------------------------
+void deleteNodeStore(NodeStore *store)
+{
+	ASSERT(store);
+	FORHASHTABLE(store->tagIds, element)
+		stdfree(element);
+	ENDHASHTABLE
+	deleteHashTable(store->tagIds);
+	if (store->nodes) stdfree(store->nodes);
+	stdfree(store->strings);
+	stdfree(store->tags);
+	if (store->roots) stdfree(store->roots);
+	stdfree(store);
+}
+
+static int tagToTagId(NodeStore*, String);
+
+//  addString -- Add a string to the string pool and return its offset. Null and empty strings
+//    have offset 0.
+//--------------------------------------------------------------------------------------------------
+static uint32_t addString(NodeStore *store, String string)
+{
+	if (!string || *string == 0) return 0;
+	uint32_t length = (uint32_t) strlen(string) + 1;
+	if (store->numBytes + length > store->maxBytes) {
+		uint32_t maxBytes = store->maxBytes;
+		while (store->numBytes + length > maxBytes) maxBytes *= 2;
+		store->strings = growArray(store->strings, store->numBytes, maxBytes);
+		store->maxBytes = maxBytes;
+	}
+	uint32_t offset = store->numBytes;
+	memcpy(store->strings + offset, string, length);
+	store->numBytes += length;
+	return offset;
+}
+
+//  addTag -- Return the ID of a tag, adding the tag to the store if it is new. Tags come from the
+//    tag table, so they are never freed and can be used as keys.
+//--------------------------------------------------------------------------------------------------
+static uint16_t addTag(NodeStore *store, String tag)
+{
+	int tagId = tagToTagId(store, tag);
+	if (tagId >= 0) return (uint16_t) tagId;
+	ASSERT(store->numTags < UINT16_MAX);
+	if (store->numTags >= store->maxTags) {
+		store->tags = growArray(store->tags, store->numTags*sizeof(String),
+								2*store->maxTags*sizeof(String));
+		store->maxTags *= 2;
+	}
+	tagId = store->numTags++;
+	store->tags[tagId] = tag;
+	insertInIntegerTable(store->tagIds, tag, tagId);
+	return (uint16_t) tagId;
+}
+
+//  tagToTagId -- Return the ID of a tag, or -1 if no node in the store has the tag.
+//--------------------------------------------------------------------------------------------------
+static int tagToTagId(NodeStore *store, String tag)
+{
+	int tagId = searchIntegerTable(store->tagIds, tag);
+	return tagId == NAN ? -1 : tagId;
+}
+
+//  newNode -- Add a node to the store and return its index. The node array may move, so callers
+//    must not keep pointers to nodes across calls.
+//--------------------------------------------------------------------------------------------------
+static NodeIndex newNode(NodeStore *store, GNode *gnode, NodeIndex parent)
+{
+	if (store->numNodes >= store->maxNodes) {
+		store->nodes = growArray(store->nodes, store->numNodes*sizeof(CompactNode),
+								 2*store->maxNodes*sizeof(CompactNode));
+		store->maxNodes *= 2;
+	}
+	NodeIndex index = store->numNodes++;
+	CompactNode *node = store->nodes + index;
+	node->parent = parent;
+	node->child = node->sibling = NONODE;
+	node->unused = 0;
+	node->tag = addTag(store, gnode->tag);
+	node->key = addString(store, gnode->key);
+	node->value = addString(store, gnode->value);
+	return index;
+}
+
+//  copyNodes -- Copy a list of sibling GNodes and their descendents into the store in depth first
+//    order. Returns the index of the first one.
+//--------------------------------------------------------------------------------------------------
+static NodeIndex copyNodes(NodeStore *store, GNode *gnode, NodeIndex parent)
+{
+	NodeIndex first = NONODE, previous = NONODE;
+	for (; gnode; gnode = gnode->sibling) {
+		NodeIndex index = newNode(store, gnode, parent);
+		if (previous) store->nodes[previous].sibling = index;
+		else first = index;
+		NodeIndex child = copyNodes(store, gnode->child, index);
+		store->nodes[index].child = child;
+		previous = index;
+	}
+	return first;
+}
+
+//  addToNodeStore -- Copy a record into a node store and return the index of its root.
+//--------------------------------------------------------------------------------------------------
+NodeIndex addToNodeStore(NodeStore *store, GNode *root)
+//  store -- Node store to add the record to.
+//  root -- Root of the record; its siblings, if any, are not copied.
+{
+	ASSERT(store && root);
+	NodeIndex index = newNode(store, root, NONODE);
+	NodeIndex child = copyNodes(store, root->child, index);
+	store->nodes[index].child = child;
+	if (store->numRoots >= store->maxRoots) {
+		store->roots = growArray(store->roots, store->numRoots*sizeof(NodeIndex),
+								 2*store->maxRoots*sizeof(NodeIndex));
+		store->maxRoots *= 2;
+	}
+	store->roots[store->numRoots++] = index;
+	return index;
+}
+
+//  nodeStoreToGNodes -- Make a GNode tree from a record in a node store. If there is an arena the
+//    nodes are allocated from it and their strings point into the store, which must outlive them.
+//    Otherwise the nodes and strings are allocated in the heap.
+//--------------------------------------------------------------------------------------------------
+static GNode *toGNodes(NodeStore *store, NodeIndex index, GNode *parent, Arena *arena)
+{
+	GNode *first = null, *previous = null;
+	for (; index; index = nsSibling(store, index)) {
+		GNode *gnode = arena
+			? createGNodeInArena(arena, nsKey(store, index), nsTag(store, index),
+								 nsValue(store, index), parent, false)
+			: createGNode(nsKey(store, index), nsTag(store, index), nsValue(store, index), parent);
+		if (previous) previous->sibling = gnode;
+		else first = gnode;
+		gnode->child = toGNodes(store, nsChild(store, index), gnode, arena);
+		previous = gnode;
+	}
+	return first;
+}
+
+GNode *nodeStoreToGNodes(NodeStore *store, NodeIndex root, Arena *arena)
+//  store -- Node store holding the record.
+//  root -- Index of the record's root.
+//  arena -- Arena to allocate the nodes from; null to use the heap.
+{
+	ASSERT(store && root);
+	GNode *gnode = arena
+		? createGNodeInArena(arena, nsKey(store, root), nsTag(store, root), nsValue(store, root),
+							 null, false)
+		: createGNode(nsKey(store, root), nsTag(store, root), nsValue(store, root), null);
+	gnode->child = toGNodes(store, nsChild(store, root), gnode, arena);
+	return gnode;
+}
+
+//  releaseNodes -- Free the nodes and roots of a node store, keeping its string pool. Used once
+//    its records have been made into GNode trees whose strings point into the pool.
+//--------------------------------------------------------------------------------------------------
+void releaseNodes(NodeStore *store)
+{
+	ASSERT(store);
+	if (store->nodes) stdfree(store->nodes);
+	if (store->roots) stdfree(store->roots);
+	store->nodes = null;
+	store->roots = null;
+	store->numNodes = store->maxNodes = store->numRoots = store->maxRoots = 0;
+}
+
+//  NodeStoreCounts -- Sizes of the arrays of a node store, written before the arrays by
+//    writeNodeStore.
+//--------------------------------------------------------------------------------------------------
+typedef struct NodeStoreCounts {
+	uint32_t numNodes;
+	uint32_t numBytes;
+	uint32_t numTags;
+	uint32_t tagBytes;
+	uint32_t numRoots;
+} NodeStoreCounts;
+
+//  writeNodeStore -- Write a node store to an open binary file. The node, string and root arrays
+//    are written as they are; the tags are written as a list of strings. Returns false if the
+//    file could not be written.
+//--------------------------------------------------------------------------------------------------
+bool writeNodeStore(NodeStore *store, FILE *file)
+{
+	ASSERT(store && file);
+	NodeStoreCounts counts = {store->numNodes, store->numBytes, store->numTags, 0, store->numRoots};
+	for (int i = 0; i < store->numTags; i++) counts.tagBytes += strlen(store->tags[i]) + 1;
+	if (fwrite(&counts, sizeof(counts), 1, file) != 1) return false;
+	if (fwrite(store->nodes, sizeof(CompactNode), counts.numNodes, file) != counts.numNodes)
+		return false;
+	if (fwrite(store->strings, 1, counts.numBytes, file) != counts.numBytes) return false;
+	for (int i = 0; i < store->numTags; i++)
+		if (fputs(store->tags[i], file) == EOF || fputc(0, file) == EOF) return false;
+	return fwrite(store->roots, sizeof(NodeIndex), counts.numRoots, file) == counts.numRoots;
+}
+
+//  readNodeStore -- Read a node store written by writeNodeStore from an open binary file. The
+//    tags are put back in the tag table. Returns null if the file is short or inconsistent.
+//--------------------------------------------------------------------------------------------------
+NodeStore *readNodeStore(FILE *file)
+{
+	ASSERT(file);
+	NodeStoreCounts counts;
+	if (fread(&counts, sizeof(counts), 1, file) != 1) return null;
+	if (counts.numNodes == 0 || counts.numBytes == 0 || counts.numTags > UINT16_MAX) return null;
+	NodeStore *store = createNodeStore();
+	if (counts.numNodes > store->maxNodes) {
+		stdfree(store->nodes);
+		store->nodes = (CompactNode*) stdalloc(counts.numNodes*sizeof(CompactNode));
+		store->maxNodes = counts.numNodes;
+	}
+	if (counts.numBytes > store->maxBytes) {
+		stdfree(store->strings);
+		store->strings = stdalloc(counts.numBytes);
+		store->maxBytes = counts.numBytes;
+	}
+	if (counts.numRoots > store->maxRoots) {
+		stdfree(store->roots);
+		store->roots = (NodeIndex*) stdalloc(counts.numRoots*sizeof(NodeIndex));
+		store->maxRoots = counts.numRoots;
+	}
+	String tagBuffer = stdalloc(counts.tagBytes + 1);
+	bool okay = fread(store->nodes, sizeof(CompactNode), counts.numNodes, file) == counts.numNodes
+		&& fread(store->strings, 1, counts.numBytes, file) == counts.numBytes
+		&& fread(tagBuffer, 1, counts.tagBytes, file) == counts.tagBytes
+		&& fread(store->roots, sizeof(NodeIndex), counts.numRoots, file) == counts.numRoots;
+	store->numNodes = counts.numNodes;
+	store->numBytes = counts.numBytes;
+
+	//  Put the tags back in the tag table in the order of their IDs.
+	tagBuffer[counts.tagBytes] = 0;
+	String tag = tagBuffer;
+	for (uint32_t i = 0; okay && i < counts.numTags; i++) {
+		if (tag >= tagBuffer + counts.tagBytes) okay = false;
+		else {
+			addTag(store, fix_tag(tag));
+			tag += strlen(tag) + 1;
+		}
+	}
+	stdfree(tagBuffer);
+
+	//  Check the links and offsets so a damaged file cannot cause wild references.
+	for (uint32_t i = 1; okay && i < store->numNodes; i++) {
+		CompactNode *node = store->nodes + i;
+		if (node->parent >= store->numNodes || node->child >= store->numNodes ||
+			node->sibling >= store->numNodes || node->tag >= store->numTags ||
+			node->key >= store->numBytes || node->value >= store->numBytes) okay = false;
+	}
+	if (okay && store->strings[store->numBytes - 1] != 0) okay = false;
+	for (uint32_t i = 0; okay && i < counts.numRoots; i++) {
+		NodeIndex root = store->roots[i];
+		if (root == NONODE || root >= store->numNodes) okay = false;
+	}
+	if (!okay) {
+		deleteNodeStore(store);
+		return null;
+	}
+	store->numRoots = counts.numRoots;
+	return store;
+}
@@ -4,12 +4,14 @@
 //  readnode.c -- Functions that read Gedcom nodes and node trees from files and strings.
 //
 //  Created by Thomas Wetmore on 17 December 2022.
-//  Last changed on 19 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "readnode.h"
 #include "stringtable.h"
 #include "errors.h"
+#include "mappedfile.h"
+#include "linescan.h"
 
 //  Return codes for fileToLine and bufferToLine.
 //-------------------------------------------------------------------------------------------------
@@ -31,48 +33,164 @@ typedef enum ReadReturnCode {
 
 //  Local static functions.
 //--------------------------------------------------------------------------------------------------
-static ReadReturnCode bufferToLine (String, int*, String*, String*, String*, Error**);
+static ReadReturnCode bufferToLine (GedcomReader*, String, LineScanCode, LineSpans*, int*, String*,
+									String*, String*, Error**);
+static GNode* readRecord(GedcomReader*, int*, ErrorLog*, bool*);
 
-//  Static variables that maintain state between some of the functions in here.
+//  fileReader -- The reader used by the functions that read from one file or mapped file at a
+//    time, firstNodeTreeFromFile and the others. Other readers are owned by their callers.
 //--------------------------------------------------------------------------------------------------
-static String fileName;  //  The name of the file being read.
-static int fileLine;  //  The current line number in the file.
-static int level;  //  The level on the last line read.
-static String key;  //  The key, if any, on the last line read.
-static String tag;  //  The tag on the last line read.
-static String value;  //  The value, if any, on the last line read.
-static bool ateof = false;  //  Whether the Gedcom file has reached end of file.
-static int fileLine = 0;  // Current line in the file being read.
+static GedcomReader fileReader;
 
 //  fileToLine -- Reads the next Gedcom line from a file. Empty lines are counted and ignored.
-//    The line is passed to bufferToLine for field extraction. An error message is returned if
-//    a problems is found. Returns a code of be OKAY, DONE, or ERROR. The function uses fgets()
-//    to read lines from the file.
+//    The line is scanned and passed to bufferToLine for field extraction. An error message is
+//    returned if a problems is found. Returns a code of be OKAY, DONE, or ERROR. The function uses
+//    fgets() to read lines from the file into the reader's buffer.
 //--------------------------------------------------------------------------------------------------
-static ReadReturnCode fileToLine(FILE *file, int *level, String *key, String *tag, String *value,
-			   Error **error)
-//  file -- File to read the line from.
+static ReadReturnCode fileToLine(GedcomReader *reader, int *level, String *key, String *tag,
+			   String *value, Error **error)
+//  reader -- Reader whose file the line is read from.
 //  level -- (out) Level of the returned line.
 //  key -- (out) Key (cross reference) of the returned line; can be null.
 //  tag -- (out) Tag of the returned line; manadatory.
 //  value -- (out) Value of the returned line; can be null.
 //  message -- (out) Error message when things go wrong.
 {
-	static char buffer[MAXLINELEN];  //  Buffer to store the line.
-	char *p = buffer;  //  Buffer cursor.
+	LineScanCode code;
+	LineSpans spans;
 	*error = null;
-	while (true) {
+	do {
 		//  Read a line from the file; if fgets returns 0 assume reading is over.
-		if (!(p = fgets(buffer, MAXLINELEN, file))) {
-			ateof = true;
+		if (!fgets(reader->buffer, MAXLINELEN, reader->file)) {
+			reader->ateof = true;
+			return ReadEOF;
+		}
+		reader->line++;  // Increment the file line number.
+		code = scanLine(reader->buffer, (int) strlen(reader->buffer), &spans);
+	} while (code == ScanBlank);  // If the line is all white continue to the next line.
+
+	// Convert the line to field values. The values point to locations in the buffer.
+	return bufferToLine(reader, reader->buffer, code, &spans, level, key, tag, value, error);
+}
+
+//  memoryToLine -- Reads the next Gedcom line from memory, normally a mapped file. Empty lines
+//    are counted and ignored. The line is scanned in place and passed to bufferToLine, which
+//    terminates its fields, so the fields returned point into the memory.
+//--------------------------------------------------------------------------------------------------
+static ReadReturnCode memoryToLine(GedcomReader *reader, int *level, String *key, String *tag,
+			   String *value, Error **error)
+//  reader -- Reader whose memory the line is read from.
+//  level -- (out) Level of the returned line.
+//  key -- (out) Key (cross reference) of the returned line; can be null.
+//  tag -- (out) Tag of the returned line; manadatory.
+//  value -- (out) Value of the returned line; can be null.
+//  error -- (out) Error when things go wrong.
+{
+	String line;
+	LineScanCode code;
+	LineSpans spans;
+	*error = null;
+	do {
+		if (reader->cursor >= reader->end) {
+			reader->ateof = true;
 			return ReadEOF;
 		}
-		fileLine++;  // Increment the file line number.
-		if (!allwhite(p)) break; // If the line is all white continue to the next line.
+		//  The last line of the memory may have no newline; it must be followed by a 0.
+		line = reader->cursor;
+		code = scanNextLine(line, reader->end, &spans, &reader->cursor);
+		reader->line++;
+	} while (code == ScanBlank);
+	return bufferToLine(reader, line, code, &spans, level, key, tag, value, error);
+}
+
+//  readLine -- Read the next Gedcom line from the reader's file or memory.
+//--------------------------------------------------------------------------------------------------
+static ReadReturnCode readLine(GedcomReader *reader, Error **error)
+{
+	if (reader->file)
+		return fileToLine(reader, &reader->level, &reader->key, &reader->tag, &reader->value, error);
+	return memoryToLine(reader, &reader->level, &reader->key, &reader->tag, &reader->value, error);
+}
+
+//  createNode -- Create a node from the fields of the last line read. Nodes read from memory
+//    point into the memory unless the reader copies strings; nodes read from files get copies of
+//    their keys and values. If the reader has an arena the nodes and any copies are allocated
+//    from it. If the reader has an intern pool, values that are copied are interned instead.
+//--------------------------------------------------------------------------------------------------
+static GNode* createNode(GedcomReader *reader, GNode *parent)
+{
+	if (reader->pool && reader->copyStrings) {
+		String value = reader->value && *reader->value ? internString(reader->pool, reader->value)
+													   : null;
+		String key = reader->key;
+		if (key) key = reader->arena ? arenaStrsave(reader->arena, key) : strsave(key);
+		if (reader->arena)
+			return createGNodeInArena(reader->arena, key, reader->tag, value, parent, false);
+		return createGNodeInPlace(key, reader->tag, value, parent);
+	}
+	if (reader->arena)
+		return createGNodeInArena(reader->arena, reader->key, reader->tag, reader->value, parent,
+								  reader->copyStrings);
+	if (reader->copyStrings) return createGNode(reader->key, reader->tag, reader->value, parent);
+	return createGNodeInPlace(reader->key, reader->tag, reader->value, parent);
+}
+
+//  freeReadNodes -- Free a tree or forest of nodes created by a reader. Nodes in an arena are
+//    freed with the arena.
+//--------------------------------------------------------------------------------------------------
+static void freeReadNodes(GedcomReader *reader, GNode *node)
+{
+	if (reader->arena) return;
+	if (reader->pool && reader->copyStrings) freeInternedGNodes(node);
+	else if (reader->copyStrings) freeGNodes(node);
+	else freeGNodesInPlace(node);
+}
+
+//  foldNode -- Join the leading CONC and CONT children of a node into its value and remove them.
+//    The joined value is stored the way createNode stores values: in the arena, in the intern
+//    pool, or in the heap. Nodes that point into the reader's memory are joined in place, since
+//    the continuation lines follow the node's line there; a node without a value then starts its
+//    value where the first continuation value was read, less the newlines that come before it.
+//    In that case a node whose continuation lines are all empty is left as it is.
+//--------------------------------------------------------------------------------------------------
+static void foldNode(GedcomReader *reader, GNode *node)
+{
+	GNode *last = node->child, *valued = null;
+	int newlines = 0;  // Newlines before the first continuation value.
+	while (isContinuation(last->sibling)) last = last->sibling;
+	for (GNode *cont = node->child; !valued && cont != last->sibling; cont = cont->sibling) {
+		if (cont->tag[3] == 'T') newlines++;
+		if (cont->value) valued = cont;
 	}
+	int length = foldedValueLength(node);
+	String value = null;
+	if (length == 0) ;
+	else if (reader->arena) value = joinValue(node, (String) arenaAlloc(reader->arena, length + 1));
+	else if (reader->copyStrings) {
+		value = joinValue(node, (String) stdalloc(length + 1));
+		if (reader->pool) {
+			String interned = internString(reader->pool, value);
+			stdfree(value);
+			value = interned;
+		} else if (node->value) stdfree(node->value);
+	} else if (node->value) value = joinValue(node, node->value);
+	else if (valued) value = joinValue(node, valued->value - newlines);
+	else return;
+	node->value = value;
+	GNode *conts = node->child;
+	node->child = last->sibling;
+	last->sibling = null;
+	freeReadNodes(reader, conts);
+}
 
-	// Read a line and convert it to field values. The values point to locations in the buffer.
-	return bufferToLine(p, level, key, tag, value, error);
+//  foldNodeTree -- Join the CONC and CONT lines of the nodes in a tree into their values.
+//--------------------------------------------------------------------------------------------------
+static void foldNodeTree(GedcomReader *reader, GNode *node)
+{
+	for (; node; node = node->sibling) {
+		if (isContinuation(node->child)) foldNode(reader, node);
+		if (node->child) foldNodeTree(reader, node->child);
+	}
 }
 
 //  stringToLine -- Get the next Gedcom line as fields from a string holding one or more Gedcom
@@ -100,156 +218,289 @@ static ReadReturnCode fileToLine(FILE *file, int *level, String *key, String *ta
 		*s = 0;
 		*ps = s + 1;
 	}
-	return bufferToLine(s0, plevel, pkey, ptag, pvalue, error) == ReadOkay;
+	LineSpans spans;
+	LineScanCode code = scanLine(s0, (int) strlen(s0), &spans);
+	return bufferToLine(null, s0, code, &spans, plevel, pkey, ptag, pvalue, error) == ReadOkay;
 }*/
 
-//  bufferToLine -- Process a Gedcom line, extracting the level, the key, if any, the tag, and
-//    the value, if any. The line may have a newline at the end. This function is called by both
-//    fileToLine and stringToLine.
+
+//  bufferToLine -- Process a scanned Gedcom line, returning the level, the key, if any, the tag,
+//    and the value, if any, or an error if the scanner found one. The fields are terminated in
+//    place, so they point into the line. The level of a line with an error is returned if it was
+//    read, and is -1 if not. This function is called by fileToLine and memoryToLine.
 //--------------------------------------------------------------------------------------------------
-static ReadReturnCode bufferToLine (String p, int* plevel, String* pkey, String* ptag, String* pvalue,
-						   Error **error)
-//  p -- Gedcom line before processing. Within the function p is used as a cursor.
+static ReadReturnCode bufferToLine (GedcomReader *reader, String p, LineScanCode code,
+						   LineSpans *spans, int* plevel, String* pkey, String* ptag,
+						   String* pvalue, Error **error)
+//  reader -- Reader the line was read by; used in error messages.
+//  p -- Gedcom line; its fields are terminated in place.
+//  code -- Result of scanning the line.
+//  spans -- Level and field locations found by the scanner.
 //  plevel -- (out) Pointer to line's Gedcom level.
 //  pkey -- (out) Pointer to line's key if any.
 //  ptag -- (out) Pointer to line's tag.
 //  pvalue -- (out) Pointer to line's value, if any.
-//  pmessage -- (out) Pointer to error message, if any, in a static buffer.
+//  error -- (out) Pointer to error, if any.
 {
-	// Be sure a string was passed in.
-	if (!p || *p == 0) {
-		*error = createError(syntaxError, fileName, fileLine, "Empty string");
-		return ReadError;
-	}
-	// Initialize the output parameters.
+	String message = null;
 	*pkey = *pvalue = 0;
-	// Strip trailing white space from the String. TODO: THIS SEEMS WASTEFUL.
-	striptrail(p);
-
-	// See if the input string is too long.
-	if (strlen(p) > MAXLINELEN) {
-		*error = createError(syntaxError, fileName, fileLine, "Line is too long");
-		return ReadError;
+	switch (code) {
+	case ScanOkay: break;
+	case ScanBlank: message = "Empty string"; break;
+	case ScanTooLong: message = "Line is too long"; break;
+	case ScanNoLevel: message = "Line does not begin with a level"; break;
+	case ScanIncomplete: message = "Line is incomplete"; break;
+	case ScanBadKey: message = "Illegal key (@@)"; break;
+	case ScanNoSpace: message = "There must be a space between the key and tag"; break;
+	case ScanNoTag: message = "The line is incomplete"; break;
 	}
-
-	// Get the level number. Pass any whitespace that precedes the level.
-	while (iswhite(*p)) p++;
-
-	// The first non-white character must be a digit for the Gedcom's line level.
-	if (chartype(*p) != DIGIT) {
-		*error = createError(syntaxError, fileName, fileLine, "Line does not begin with a level");
+	if (message) {
+		bool leveled = code != ScanBlank && code != ScanTooLong && code != ScanNoLevel;
+		*plevel = leveled ? spans->level : -1;
+		*error = createError(syntaxError, reader->fileName, reader->line, message);
 		return ReadError;
 	}
+	// MNOTE: The key, tag and value point into the original string.
+	*plevel = spans->level;
+	p[spans->end] = 0;
+	if (spans->key.start >= 0) {
+		*pkey = p + spans->key.start;
+		p[spans->key.start + spans->key.length] = 0;
+	}
+	*ptag = p + spans->tag.start;
+	p[spans->tag.start + spans->tag.length] = 0;
+	if (spans->value.start >= 0) *pvalue = p + spans->value.start;
+	return ReadOkay;
+}
 
-	// Use ascii arithmetic to convert the digit characters to integers.
-	int level = *p++ - '0';
-	while (chartype(*p) == DIGIT) level = level*10 + *p++ - '0';
-	
-	// Set the output level parameter to its value.
-	*plevel = level;
-
-	// Pass any white space that precedes the key or tag.
-	while (iswhite(*p)) p++;
+// createGedcomReader -- Create a reader that reads Gedcom records from a file. The reader opens
+//    the file and closes it when deleted. Returns null if the file cannot be opened. Each reader
+//    keeps its own state, so different threads can read different files at the same time.
+//    MNOTE: The file name is not copied; it must outlive the reader and the errors it logs.
+//--------------------------------------------------------------------------------------------------
+GedcomReader *createGedcomReader(String fileName)
+//  fileName -- Name of the Gedcom file to read.
+{
+	ASSERT(fileName);
+	FILE *file = fopen(fileName, "r");
+	if (!file) return null;
+	GedcomReader *reader = (GedcomReader*) stdalloc(sizeof(GedcomReader));
+	initFileReader(reader, file, fileName);
+	reader->ownsFile = true;
+	return reader;
+}
 
-	// If at the end of the string it is an error.
-	if (*p == 0) {
-		*error = createError(syntaxError, fileName, fileLine, "Line is incomplete");
-		return ReadError;
-	}
+// createMappedGedcomReader -- Create a reader that reads Gedcom records from a mapped file. The
+//    nodes point into the mapping, so the mapping must outlive them.
+//--------------------------------------------------------------------------------------------------
+GedcomReader *createMappedGedcomReader(MappedFile *file)
+//  file -- Mapped Gedcom file to read.
+{
+	ASSERT(file);
+	GedcomReader *reader = (GedcomReader*) stdalloc(sizeof(GedcomReader));
+	initMemoryReader(reader, file->data, file->data + file->size, file->fileName);
+	return reader;
+}
 
-	// If @ is the first character, this line has a key.
-	if (*p != '@') goto gettag;
+// deleteGedcomReader -- Delete a reader, closing its file if it opened it.
+//--------------------------------------------------------------------------------------------------
+void deleteGedcomReader(GedcomReader *reader)
+{
+	ASSERT(reader);
+	if (reader->ownsFile) fclose(reader->file);
+	if (reader->pending) deleteError(reader->pending);
+	stdfree(reader);
+}
 
-	// Get the key including @'s.
-	*pkey = p++;  // MNOTE: Key points into the original string.
-	if (*p == '@') {  // @@ is illegal.
-		*error = createError(syntaxError, fileName, fileLine, "Illegal key (@@)");
-		return ReadError;
-	}
-	while (*p != '@' && *p != 0) p++;  // Read until the second @-sign.
-	//  If at the end of the string it is an error.
-	if (*p == 0) {
-		*error = createError(syntaxError, fileName, fileLine, "Line is incomplete");
-		return ReadError;
-	}
-	//  p now points to the second @-sign. Put a space into the next character (which will be
-	//    between the 2nd @ and the first character of the tag).
-	if (*++p != ' ') {
-		*error = createError(syntaxError, fileName, fileLine, "There must be a space between the key and tag");
-		return ReadError;
-	}
-	*p++ = 0;
+// initFileReader -- Initialize a reader that reads Gedcom records from a file.
+//--------------------------------------------------------------------------------------------------
+void initFileReader(GedcomReader *reader, FILE *file, String fileName)
+//  reader -- Reader to initialize.
+//  file -- Open file that holds Gedcom records.
+//  fileName -- Name of the file, used in error messages; can be null.
+{
+	ASSERT(reader && file);
+	reader->fileName = fileName;
+	reader->file = file;
+	reader->cursor = reader->end = null;
+	reader->line = 0;
+	reader->started = reader->ateof = reader->ownsFile = false;
+	reader->pending = null;
+	reader->copyStrings = true;
+	reader->arena = null;
+	reader->pool = null;
+	reader->foldContinuations = false;
+	reader->skipBadRecords = false;
+}
 
-	// Get the tag field.
-gettag:
-	while (iswhite(*p)) p++;  // Allow additional white space.
-	if ((int) *p == 0) {
-		*error = createError(syntaxError, fileName, fileLine, "The line is incomplete");
-		return ReadError;
-	}
-	*ptag = p++;  // MNOTE: The returned tag points into the original string.
-	while (!iswhite(*p) && *p != 0) p++;
-	if (*p == 0) return ReadOkay;
-	*p++ = 0;
-
-	// Get the value field.
-	while (iswhite(*p)) p++;
-	*pvalue = p;  // MNOTE: The returned value points into the original string.
-	return ReadOkay;
+// initMemoryReader -- Initialize a reader that reads Gedcom records from memory, normally all or
+//    part of a mapped file. The memory is changed as it is read, so it cannot be read again, and
+//    the nodes point into it, so it must outlive them. Free the trees with freeGNodesInPlace. If
+//    copyStrings is set after initializing, the nodes get copies, and the memory can be reused.
+//--------------------------------------------------------------------------------------------------
+void initMemoryReader(GedcomReader *reader, String start, String end, String fileName)
+//  reader -- Reader to initialize.
+//  start -- First character of the memory; must be the start of a line.
+//  end -- Character after the last character of the memory; must be the start of a line or a 0.
+//  fileName -- Name of the file, used in error messages; can be null.
+{
+	ASSERT(reader && start && end && start <= end);
+	reader->fileName = fileName;
+	reader->file = null;
+	reader->cursor = start;
+	reader->end = end;
+	reader->line = 0;
+	reader->started = reader->ateof = reader->ownsFile = reader->copyStrings = false;
+	reader->pending = null;
+	reader->arena = null;
+	reader->pool = null;
+	reader->foldContinuations = false;
+	reader->skipBadRecords = false;
 }
 
 // firstNodeTreeFromFile -- Convert first Gedcom record in a file to a gedcom node tree.
 //--------------------------------------------------------------------------------------------------
 GNode* firstNodeTreeFromFile (FILE *fp, int *lineNo, ErrorLog *errorLog)
 //  fp -- (in) File that holds Gedcom records.
-//  pmsg -- (out) Possible error message.
-//  peof -- (out) Set to true if the file is at end of file.
+//  lineNo -- (out) Line number where the record begins.
+//  errorLog -- Error log.
 {
-	ateof = false;
-	fileLine = 0;
-	Error *error = null;
-	ReadReturnCode rc = fileToLine(fp, &level, &key, &tag, &value, &error);
-	if (rc == ReadEOF) {
-		ateof = true;
-		addErrorToLog(errorLog, createError(systemError, fileName, fileLine, "the file is empty"));
-		if (error) deleteError((Word) error);
-		return null;
-	} else if (rc == ReadError) {
-		addErrorToLog(errorLog, error);
-		return null;
-	}
-	return nextNodeTreeFromFile(fp, lineNo, errorLog);
+	initFileReader(&fileReader, fp, null);
+	return readNodeTree(&fileReader, lineNo, errorLog);
 }
 
 //  nextNodeTreeFromFile -- Convert the next Gedcom record in a file to a Node tree.
 //--------------------------------------------------------------------------------------------------
 GNode* nextNodeTreeFromFile(FILE *fp, int *lineNo, ErrorLog *errorLog)
 //  fp -- File that holds the Gedcom records.
-//  pmsg -- (out) Possible error message.
-//  peof -- (out) Set to true if the file is at end of file.
+//  lineNo -- (out) Line number where the record begins.
+//  errorLog -- Error log.
+{
+	ASSERT(fp == fileReader.file);
+	return readNodeTree(&fileReader, lineNo, errorLog);
+}
+
+//  firstNodeTreeFromMappedFile -- Convert the first Gedcom record in a mapped file to a node
+//    tree. The nodes point into the mapping, which is changed as it is read, so the mapping must
+//    not be read again, and it must outlive the trees. Free the trees with freeGNodesInPlace.
+//--------------------------------------------------------------------------------------------------
+GNode* firstNodeTreeFromMappedFile(MappedFile *file, int *lineNo, ErrorLog *errorLog)
+//  file -- Mapped file that holds Gedcom records.
+//  lineNo -- (out) Line number where the record begins.
+//  errorLog -- Error log.
+{
+	ASSERT(file);
+	initMemoryReader(&fileReader, file->data, file->data + file->size, file->fileName);
+	return readNodeTree(&fileReader, lineNo, errorLog);
+}
+
+//  nextNodeTreeFromMappedFile -- Convert the next Gedcom record in a mapped file to a node tree.
+//--------------------------------------------------------------------------------------------------
+GNode* nextNodeTreeFromMappedFile(MappedFile *file, int *lineNo, ErrorLog *errorLog)
+{
+	ASSERT(file && !fileReader.file);
+	return readNodeTree(&fileReader, lineNo, errorLog);
+}
+
+//  skipToNextRecord -- After an error, read lines until a level 0 line is read without error, so
+//    reading can start again with its record. Errors in the lines skipped are not logged; the
+//    record the error was found in has been logged already. Returns false at the end of the file
+//    or memory.
+//--------------------------------------------------------------------------------------------------
+static bool skipToNextRecord(GedcomReader *reader)
+{
+	Error *error = null;
+	while (true) {
+		ReadReturnCode rc = readLine(reader, &error);
+		if (error) {
+			deleteError((Word) error);
+			error = null;
+		}
+		if (rc == ReadEOF) return false;
+		if (rc == ReadOkay && reader->level == 0) return true;
+	}
+}
+
+//  readNodeTree -- Convert the next Gedcom record read by a reader to a node tree. Returns null
+//    when there are no more records or an error is found. If the reader skips bad records, an
+//    error is logged for each record that has one, and reading goes on with the next record; null
+//    is then only returned at the end of the file or memory.
+//--------------------------------------------------------------------------------------------------
+GNode* readNodeTree(GedcomReader *reader, int *lineNo, ErrorLog *errorLog)
+//  reader -- Reader to read the record with.
+//  lineNo -- (out) Line number where the record begins.
+//  errorLog -- Error log.
+{
+	bool failed;
+	GNode *root = readRecord(reader, lineNo, errorLog, &failed);
+	while (!root && failed && reader->skipBadRecords && skipToNextRecord(reader))
+		root = readRecord(reader, lineNo, errorLog, &failed);
+	return root;
+}
+
+//  readRecord -- Convert the next Gedcom record read by a reader to a node tree. Returns null
+//    when there are no more records or an error is found; failed tells which. A line that can't
+//    be read but has level 0, or has no level, may be the first line of the next record, so it
+//    ends the record being read, which is returned; the line's error is held by the reader and
+//    becomes the next record's error. A line that can't be read at a deeper level is an error in
+//    the record being read.
+//--------------------------------------------------------------------------------------------------
+static GNode* readRecord(GedcomReader *reader, int *lineNo, ErrorLog *errorLog, bool *failed)
+//  reader -- Reader to read the record with.
+//  lineNo -- (out) Line number where the record begins.
+//  errorLog -- Error log.
+//  failed -- (out) Whether an error was found.
 {
 	ReadReturnCode bcode, rc;
 	GNode *root, *node, *curnode;
-	Error *error;
+	Error *error = null;
+	*failed = false;
+
+	//  The first time through read the first line of the first record.
+	if (!reader->started) {
+		reader->started = true;
+		rc = readLine(reader, &error);
+		if (rc == ReadEOF) {
+			addErrorToLog(errorLog, createError(systemError, reader->fileName, reader->line,
+												"the file is empty"));
+			if (error) deleteError((Word) error);
+			return null;
+		} else if (rc == ReadError) {
+			addErrorToLog(errorLog, error);
+			*failed = true;
+			return null;
+		}
+	}
+
+	//  If the line after the last record could not be read, this record has its error.
+	if (reader->pending) {
+		addErrorToLog(errorLog, reader->pending);
+		reader->pending = null;
+		*failed = true;
+		return null;
+	}
+
 	// If file is at end return EOF.
-	if (ateof) return null;
+	if (reader->ateof) return null;
 
 	//  The first line in the record has been read and must have level 0.
-	int curlev = level;
+	int curlev = reader->level;
 	if (curlev != 0)  {
-		addErrorToLog(errorLog, createError(syntaxError, fileName, fileLine, "Record does not start at level 0"));
-		//  Read ahead for a line with level 0.
-		//while ((rc = fileToLine(fp, &level, &key, &value, &error)))
+		addErrorToLog(errorLog, createError(syntaxError, reader->fileName, reader->line,
+											"Record does not start at level 0"));
+		*failed = true;
 		return null;
 	}
 
 	//  Create the root of a node tree.
-	root = curnode = createGNode(key, tag, value, null);
+	if (lineNo) *lineNo = reader->line;
+	root = curnode = createNode(reader, null);
 	bcode = ReadOkay;
 
 	//  Read the lines of the current record and build its tree.
-	rc = fileToLine(fp, &level, &key, &tag, &value, &error);
+	rc = readLine(reader, &error);
 	while (rc == ReadOkay) {
+		int level = reader->level;
 
 		//  If the level is zero the the record has been read and built.
 		if (level == 0) {
@@ -259,13 +510,13 @@ GNode* nextNodeTreeFromFile(FILE *fp, int *lineNo, ErrorLog *errorLog)
 
 		//  If the level of this line is the same as the last, add a sibling node.
 		if (level == curlev) {
-			node = createGNode(key, tag, value, curnode->parent);
+			node = createNode(reader, curnode->parent);
 			curnode->sibling = node;
 			curnode = node;
 
 			//  If the level of this line is one deeper than the last, add a child node.
 		} else if (level == curlev + 1) {
-			node = createGNode(key, tag, value, curnode);
+			node = createNode(reader, curnode);
 			curnode->child = node;
 			curnode = node;
 			curlev = level;
@@ -276,7 +527,8 @@ GNode* nextNodeTreeFromFile(FILE *fp, int *lineNo, ErrorLog *errorLog)
 
 			// Check for an illegal level.
 			if (level < 0) {
-				addErrorToLog(errorLog, createError(syntaxError, fileName, fileLine, "Illegal level"));
+				addErrorToLog(errorLog, createError(syntaxError, reader->fileName, reader->line,
+													"Illegal level"));
 				bcode = ReadError;
 				break;
 			}
@@ -288,29 +540,36 @@ GNode* nextNodeTreeFromFile(FILE *fp, int *lineNo, ErrorLog *errorLog)
 			}
 
 			//  Add the new node as a sibling.
-			node = createGNode(key, tag, value, curnode->parent);
+			node = createNode(reader, curnode->parent);
 			curnode->sibling = node;
 			curnode = node;
 
 		//  Anything else is an error.
 		} else {
-			addErrorToLog(errorLog, createError(syntaxError, fileName, fileLine, "Illegal line"));
+			addErrorToLog(errorLog, createError(syntaxError, reader->fileName, reader->line,
+												"Illegal line"));
 			bcode = ReadError;
 			break;
 		}
 		//  The line was converted to a node and inserted. Read the next line and continue.
-		rc = fileToLine(fp, &level, &key, &tag, &value, &error);
+		rc = readLine(reader, &error);
 	}
 
-	//  At the end of the loop. If the code was successful return the tree root.
-	if (bcode == ReadOkay) return root;
-	if (bcode == ReadError || rc == ReadError) {
+	//  At the end of the loop. If a line could not be read and may start the next record, keep its
+	//  error for that record. If a line had a bad level, or could not be read inside this record,
+	//  free the nodes rooted at root and return null. Otherwise return the tree root, with its
+	//  continuation lines folded if asked for.
+	if (rc == ReadError && reader->level <= 0) reader->pending = error;
+	else if (rc == ReadError) {
 		addErrorToLog(errorLog, error);
-		// If there were errors free all nodes rooted at root and return null.
-		freeGNodes(root);
+		bcode = ReadError;
+	}
+	if (bcode == ReadError) {
+		freeReadNodes(reader, root);
+		*failed = true;
 		return null;
 	}
-	ateof = true ;
+	if (reader->foldContinuations) foldNodeTree(reader, root);
 	return root;
 }
 
@@ -5,7 +5,7 @@
 //    files.
 //
 //  Created by Thomas Wetmore on 2 May 2023.
-//  Last changed on 2 May 2023
+//  Last changed on 17 October 2026.
 //
 
 #include "standard.h"
@@ -19,6 +19,12 @@ void writeGNode(FILE*, int level, GNode*, bool indent);
 static String swriteGNodes(int level, GNode*, String);
 static String swriteGNode(int level, GNode*, String);
 static int nodeStringLength(int, GNode*);
+static int valuePiece(String, String*, bool*);
+
+//  MAXVALUEPIECE -- Longest piece of a value written on one line. Longer lines of a value are
+//    split with CONC lines, keeping the lines written under the 255 characters Gedcom allows.
+//--------------------------------------------------------------------------------------------------
+#define MAXVALUEPIECE 200
 
 //  gnodesToFile -- Write a gedcom tree to a gedcom file. Opens the file, calls writeGNodes to
 //    write the nodes, and closes the file. Returns whether the write occurred.
@@ -40,7 +46,36 @@ bool gnodesToFile(int level, GNode* gnode, String fileName, bool indent)
     return true;
 }
 
-//  writeGNode -- Write a single gedcom node to a file. Called by writeGNodes.
+//  valuePiece -- Find the first piece of a value that is written on one line. A value folded from
+//    CONC and CONT lines at import is written back out as those lines: each newline starts a CONT
+//    line, and lines longer than MAXVALUEPIECE are split into CONC lines. Splits are not made next
+//    to a space, which would be lost when the line is read, or inside a UTF-8 character. Returns
+//    the length of the piece and sets next to the rest of the value, or to null if there is none.
+//--------------------------------------------------------------------------------------------------
+static int valuePiece(String value, String *next, bool *cont)
+//  value -- Value, or the rest of a value, to write.
+//  next -- (out) Rest of the value after the piece; null if the piece is the last.
+//  cont -- (out) Whether the rest of the value goes on a CONT line rather than a CONC line.
+{
+    int length = 0;
+    while (value[length] && value[length] != '\n') length++;
+    if (length > MAXVALUEPIECE) {
+        int cut = MAXVALUEPIECE;
+        while (cut > 1 && (value[cut - 1] == ' ' || value[cut] == ' ' ||
+                           (value[cut] & 0xc0) == 0x80)) cut--;
+        if (cut > 1) {
+            *next = value + cut;
+            *cont = false;
+            return cut;
+        }
+    }
+    *next = value[length] == '\n' ? value + length + 1 : null;
+    *cont = true;
+    return length;
+}
+
+//  writeGNode -- Write a single gedcom node to a file, followed by the CONC and CONT lines of its
+//    value if it has more than one line. Called by writeGNodes.
 //--------------------------------------------------------------------------------------------------
 void writeGNode(FILE *fp, int level, GNode* gnode, bool indent)
 //  fp -- Output file.
@@ -52,8 +87,22 @@ void writeGNode(FILE *fp, int level, GNode* gnode, bool indent)
     fprintf(fp, "%d", level);
     if (gnode->key) fprintf(fp, " %s", gnode->key);
     fprintf(fp, " %s", gnode->tag);
-    if (gnode->value) fprintf(fp, " %s", gnode->value);
+    String next = null;
+    bool cont = false;
+    if (gnode->value) {
+        int length = valuePiece(gnode->value, &next, &cont);
+        if (length) fprintf(fp, " %.*s", length, gnode->value);
+    }
     fprintf(fp, "\n");
+    while (next) {
+        String value = next;
+        bool isCont = cont;
+        int length = valuePiece(value, &next, &cont);
+        if (indent) for (int i = 0; i < level; i++) fprintf(fp, "  ");
+        fprintf(fp, "%d %s", level + 1, isCont ? "CONT" : "CONC");
+        if (length) fprintf(fp, " %.*s", length, value);
+        fprintf(fp, "\n");
+    }
 }
 
 //  writeGNodes -- Write a node tree or forest to a Gedcom file. Recurse to children and siblings.
@@ -110,41 +159,38 @@ String gnodeToString(GNode* gnode, int level)
     return string;
 }
 
-//  swriteGNode -- Write a Node to a string. Returns the next location in the String p to add the
-//    next GNode.
+//  swriteGNode -- Write a Node to a string, followed by the CONC and CONT lines of its value if
+//    it has more than one line. Returns the next location in the String p to add the next GNode.
 //--------------------------------------------------------------------------------------------------
 static String swriteGNode(int level, GNode* node, String p)
 // level -- Level of this GNode.
 // node -- GNode to render as a String.
 // p -- Location to copy the String to before returning.
 {
-    // Buffer use only to compose the line.
-    char scratch[600];
-    String q = scratch;
-    // Write the level to the buffer.
-    sprintf(q, "%d ", level);
-    q += strlen(q);
-    // If the GNode has a key write it to buffer.
-    if (node->key) {
-        strcpy(q, node->key);
-        q += strlen(q);
-        *q++ = ' ';
-    }
-    // Write the tag to the buffer.
-    strcpy(q, node->tag);
-    q += strlen(q);
-    // If the GNode has a value write it to the buffer.
+    // Write the level, the key if there is one, and the tag.
+    p += sprintf(p, "%d ", level);
+    if (node->key) p += sprintf(p, "%s ", node->key);
+    p += sprintf(p, "%s", node->tag);
+    // If the GNode has a value write its first line.
+    String next = null;
+    bool cont = false;
     if (node->value) {
-        *q++ = ' ';
-        strcpy(q, node->value);
-        q += strlen(q);
+        int length = valuePiece(node->value, &next, &cont);
+        if (length) p += sprintf(p, " %.*s", length, node->value);
     }
-    // Add a newline to the buffer, and then copy the buffer to the end of the input String.
-    *q++ = '\n';
-    *q = 0;
-    strcpy(p, scratch);
+    *p++ = '\n';
+    // Write the rest of the value on continuation lines.
+    while (next) {
+        String value = next;
+        bool isCont = cont;
+        int length = valuePiece(value, &next, &cont);
+        p += sprintf(p, "%d %s", level + 1, isCont ? "CONT" : "CONC");
+        if (length) p += sprintf(p, " %.*s", length, value);
+        *p++ = '\n';
+    }
+    *p = 0;
     // Return the position in the input String where the next GNode line will go.
-    return p + strlen(p);
+    return p;
 }
 
 //  swriteGNodes -- Write GNode tree to String. Recurses to children and siblings.
@@ -194,5 +240,13 @@ static int nodeStringLength(int level, GNode* gnode)
     if (gnode->key) len += strlen(gnode->key) + 3; // + 3 for space and 2 @-signs.
     len += strlen(gnode->tag);
     if (gnode->value) len += strlen(gnode->value) + 1;  // + 1 for the space after the tag.
+    // Add each continuation line's level, which may have one more digit, tag, spaces and newline.
+    String next = gnode->value;
+    bool cont;
+    if (next) valuePiece(next, &next, &cont);
+    while (next) {
+        valuePiece(next, &next, &cont);
+        len += strlen(scratch) + 8;
+    }
     return (int) len + 1;  // + 1 for the newline.
 }
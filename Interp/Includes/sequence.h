@@ -4,7 +4,7 @@
 //  sequence.h -- Header file for the Sequence datatype.
 //
 //  Created by Thomas Wetmore on 1 March 2023.
-//  Last changed on 16 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef sequence_h
@@ -23,6 +23,7 @@ typedef struct SequenceEl {
 	String key;     // Person or family key.  (TODO: Would it be better to use root GNodes here?)
 	String name;    // Name of person.
 	PValue *value;  // Any program value.
+	RecordId id;    // Id of the record with the key; NORECORDID if it isn't in the database.
 }
 *SequenceEl;
 
@@ -47,6 +48,7 @@ struct Sequence {
 #define NAMESORT  (1<<1)
 #define UNIQUED   (1<<2)
 #define VALUESORT (1<<3)
+#define IDSORT    (1<<4)  // Sorted by record id, the order the set operations use.
 
 Sequence *createSequence(Database*);  // Create a sequence.
 void deleteSequence(Sequence*, bool fval);  //  Delete a sequence.
@@ -69,6 +71,7 @@ Sequence *familyToMothers(GNode *family, Database*);  //  Return sequence of a f
 Sequence *personToSpouses(GNode *person, Database*);  //  Return sequence of a person's spouses.
 Sequence *personToFamilies(GNode *person, bool, Database*);  //  Return sequence of a person's families.
 Sequence *nameToSequence(String, Database*);  //  Return sequence of persons who match a name.
+Sequence *surnamePrefixToSequence(String, Database*);  //  Return persons with a surname prefix.
 Sequence *refn_to_indiseq(String refn);
 
 Sequence *unionSequence(Sequence*, Sequence*);
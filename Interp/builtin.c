@@ -15,7 +15,7 @@
 #include "pnode.h"    // PNode.
 #include "name.h"     // getSurname, manipulateName.
 #include "interp.h"
-#include "recordindex.h" // searchRecordIndex.
+#include "recordindex.h" // RecordIndex.
 #include "database.h"    // personIndex, familyIndex.
 #include "hashtable.h"
 //#include "gedcom.h"
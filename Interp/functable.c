@@ -4,7 +4,7 @@
 //  functable.c -- Table of the built-in functions in the DeadEnds programming language.
 //
 //  Created by Thomas Wetmore on 10 January 2023.
-//  Last changed on 16 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "standard.h"
@@ -162,6 +162,7 @@ extern PValue __strtoint(PNode*, Context*, bool*);
 extern PValue __sub(PNode*, Context*, bool*);
 extern PValue __substring(PNode*, Context*, bool*);
 extern PValue __surname(PNode*, Context*, bool*);
+extern PValue __surnameset(PNode*, Context*, bool*);
 extern PValue __system(PNode*, Context*, bool*);
 extern PValue __table(PNode*, Context*, bool*);
 extern PValue __tag(PNode*, Context*, bool*);
@@ -342,6 +343,7 @@ BuiltIn builtIns[] = {
     "sub",        2,    2,    __sub,
 //    "substring",    3,    3,    __substring,
     "surname",    1,    1,    __surname,
+    "surnameset",    1,    1,    __surnameset,  // Persons with a surname prefix.
 //    "system",    1,    1,    __system,
     "table",    1,    1,    __table,
     "tag",        1,    1,    __tag,
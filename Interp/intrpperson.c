@@ -4,7 +4,7 @@
 //  intrpperson.c -- Built-in functions dealing with persons.
 //
 //  Created by Thomas Wetmore on 17 March 2023.
-//  Last changed on 16 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "standard.h"
@@ -51,9 +51,12 @@ PValue __name(PNode *pnode, Context *context, bool* errflg)
         return nullPValue;
     }
 
-    //  Use manipulateName to return a string in data space.
-    String name = manipulateName(nameNode->value, useCaps, true, 68);
-    //  MNOTE: The program value below has a pointer to data space, not heap space.
+    //  Use the person's name forms if they have the name; otherwise manipulateName.
+    NameForms *forms = personToNameForms(indi, context->database);
+    String name = null;
+    if (forms && forms->display) name = useCaps ? forms->capsDisplay : forms->display;
+    else name = manipulateName(nameNode->value, useCaps, true, NAMEDISPLAYLEN);
+    //  MNOTE: The program value below has a pointer to data or database space, not heap space.
     if (name) return PVALUE(PVString, uString, name);
     else return nullPValue;
 }
@@ -115,12 +118,14 @@ PValue __surname (PNode *pnode, Context *context, bool* errflg)
         prog_error(pnode, "the argument to surname must be a person");
         return nullPValue;
     }
-    if (!(gnode = NAME(gnode)) || !gnode->value) {
+    GNode *name = NAME(gnode);
+    if (!name || !name->value) {
         *errflg = true;
         prog_error(pnode, "the person must have a name");
         return nullPValue;
     }
-    return PVALUE(PVString, uString, getSurname(gnode->value));
+    NameForms *forms = personToNameForms(gnode, context->database);
+    return PVALUE(PVString, uString, forms ? forms->surname : getSurname(name->value));
 }
 
 //  __givens -- Get the given names of a person. They are returned as a single string.
@@ -134,12 +139,14 @@ PValue __givens(PNode *pnode, Context *context, bool* errflg)
         prog_error(pnode, "the argument to givens must be a person");
         return nullPValue;
     }
-    if (!(this = NAME(this)) || !this->value) {
+    GNode *name = NAME(this);
+    if (!name || !name->value) {
         *errflg = true;
         prog_error(pnode, "the person must have a name");
         return nullPValue;
     }
-    return PVALUE(PVString, uString, getGivenNames(this->value));
+    NameForms *forms = personToNameForms(this, context->database);
+    return PVALUE(PVString, uString, forms ? forms->givens : getGivenNames(name->value));
 }
 
 //  __trimname -- Trim name if too long
@@ -381,11 +388,15 @@ PValue __soundex (PNode *expr, Context *context, bool* eflg)
 {
     GNode* gnode = evaluatePerson(expr->arguments, context, eflg);
     if (*eflg || !gnode || nestr(gnode->tag, "INDI")) return nullPValue;
-    if (!(gnode = NAME(gnode)) || !gnode->value) {
+    GNode *name = NAME(gnode);
+    if (!name || !name->value) {
         *eflg = true;
         return nullPValue;
     }
-    return PVALUE(PVString, uString, strsave(soundex(getSurname(gnode->value))));
+    //  The name key is the first initial followed by the Soundex code of the surname.
+    NameForms *forms = personToNameForms(gnode, context->database);
+    return PVALUE(PVString, uString, strsave(forms ? forms->nameKey + 1 :
+                                             soundex(getSurname(name->value))));
 }
 
 //  __inode -- Return the root of a person.
@@ -5,7 +5,7 @@
 //    programming language this datatype is called an indiset.
 //
 //  Created by Thomas Wetmore on 4 March 2023.
-//  Last changed on 16 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include <stdio.h>
@@ -317,6 +317,22 @@ PValue __difference(PNode *node, Context *context, bool *eflg)
     //push_list(keysets, op2);
 }
 
+//  __surnameset -- Create the sequence of persons with surnames that start with a prefix. The
+//    case of the letters does not matter.
+//    usage: surnameset(STRING) -> SET
+//--------------------------------------------------------------------------------------------------
+PValue __surnameset(PNode *node, Context *context, bool *eflg)
+{
+    PValue val = evaluate(node->arguments, context, eflg);
+    if (*eflg || val.type != PVString || !val.value.uString) {
+        *eflg = true;
+        prog_error(node, "the arg to surnameset must be a string.");
+        return nullPValue;
+    }
+    Sequence *seq = surnamePrefixToSequence(val.value.uString, context->database);
+    return PVALUE(PVSequence, uSequence, seq);
+}
+
 //  __parentset -- Create the parent sequence of a sequence.
 //    usage: parentset(SET) -> SET
 //--------------------------------------------------------------------------------------------------
@@ -6,7 +6,7 @@
 //    indiseq data type of DeadEndsScript.
 //
 //  Created by Thomas Wetmore on 1 March 2023.
-//  Last changed on 22 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "standard.h"
@@ -26,11 +26,16 @@ static bool debugging = false;
 
 //  Compare functions used when sorting sequences of persons.
 //--------------------------------------------------------------------------------------------------
-static int nameCompare(SequenceEl, SequenceEl);  // Compare by Gedcom names.
+typedef struct NameSortEl NameSortEl;
+static int nameCompare(NameSortEl*, NameSortEl*);  // Compare by Gedcom names.
 static int keyCompare(SequenceEl, SequenceEl);  // Compare by key values.
 static int valueCompare(SequenceEl, SequenceEl);  // Compare by value values.
+static int idCompare(SequenceEl, SequenceEl);  // Compare by record ids.
 
 static void sequenceSort(Word*, int, int(*compare)(Word, Word));
+static void idSortSequence(Sequence*);
+static void addElement(Sequence*, SequenceEl);
+static void appendElement(Sequence*, SequenceEl);
 
 void baseFree(Word word) { stdfree(word); }
 
@@ -87,6 +92,25 @@ Sequence *copySequence(Sequence *seq)
 	return new;
 }
 
+//  addElement -- Add an element to the end of a sequence, growing its array if needed.
+//--------------------------------------------------------------------------------------------------
+static void addElement(Sequence *sequence, SequenceEl el)
+{
+	int n = sequence->size;
+	SequenceEl* old = IData(sequence);
+	if (n >= sequence->max)  {
+		int m = 3*n;
+		SequenceEl* new = (SequenceEl*) stdalloc(m*sizeof(SequenceEl));
+		for (int i = 0; i < n; i++)
+			new[i] = old[i];
+		stdfree(old);
+		IData(sequence) = old = new;
+		sequence->max = m;
+	}
+	old[(sequence->size)++] = el;
+	sequence->flags = 0;  // The sequence may no longer be sorted or unique.
+}
+
 //  appendToSequence -- Create and append a new element to a sequence.
 //--------------------------------------------------------------------------------------------------
 void appendToSequence(Sequence *sequence, String key, String name, PValue *val)
@@ -96,8 +120,6 @@ void appendToSequence(Sequence *sequence, String key, String name, PValue *val)
 //  val -- an extra value; may be null; otherwise is must point to a pvalue??
 {
 	if (!sequence || !key) return;
-	int n = sequence->size;
-	SequenceEl* old = IData(sequence);
 	SequenceEl el = (SequenceEl) stdalloc(sizeof(*el));
 	el->key = strsave(key);  // Sequence elements own their copies of the keys.
 	el->name = null;
@@ -106,20 +128,21 @@ void appendToSequence(Sequence *sequence, String key, String name, PValue *val)
 		else el->name = strsave(key_to_name(key, sequence->database));
 	}
 	el->value = val;  // They don't own the value fields.
-	//spri(el) = 0;
+	el->id = sequence->database ? keyToRecordId(key, sequence->database) : NORECORDID;
+	addElement(sequence, el);
+}
 
-	// Check if the list of elements needs to grow.
-	if ((n = sequence->size) >= sequence->max)  {
-		int m = 3*n;
-		SequenceEl* new = (SequenceEl*) stdalloc(m*sizeof(SequenceEl));
-		for (int i = 0; i < n; i++)
-			new[i] = old[i];
-		stdfree(old);
-		IData(sequence) = old = new;
-		sequence->max = m;
-	}
-	old[(sequence->size)++] = el;
-	sequence->max = 0;
+//  appendElement -- Append a copy of an element of another sequence to a sequence. The name and
+//    record id are copied rather than looked up again.
+//--------------------------------------------------------------------------------------------------
+static void appendElement(Sequence *sequence, SequenceEl element)
+{
+	SequenceEl el = (SequenceEl) stdalloc(sizeof(*el));
+	el->key = strsave(element->key);
+	el->name = element->name ? strsave(element->name) : null;
+	el->value = element->value;
+	el->id = element->id;
+	addElement(sequence, el);
 }
 
 //  rename_indiseq -- Update element name with standard name
@@ -207,15 +230,25 @@ bool element_indiseq (Sequence *seq, int index, String* pkey, String* pname)
 	return true;
 }
 
-//  nameCompare -- Compare two sequence elements by their name fields. The elements must hold
-//    persons.
+//  NameSortEl -- A sequence element and the forms of its name, sorted by nameSortSequence.
+//--------------------------------------------------------------------------------------------------
+struct NameSortEl {
+	SequenceEl element;  // Element of the sequence.
+	NameForms *forms;    // Forms of the element's name; null if it has none.
+	bool owned;          // Whether the forms were made for the sort rather than by the database.
+};
+
+//  nameCompare -- Compare two sequence elements by their names, using their name forms. The
+//    elements must hold persons. Elements without names come first.
 //--------------------------------------------------------------------------------------------------
-static int nameCompare(SequenceEl el1, SequenceEl el2)
+static int nameCompare(NameSortEl *el1, NameSortEl *el2)
 //  el1, el2 -- The two elements with the names to be compared.
 {
-	int rel = compareNames(el1->name, el2->name);
-	if (rel) return rel;  // If names are not equal return their relationship.
-	return compareRecordKeys(el1->key, el2->key);
+	if (el1->forms && el2->forms) {
+		int rel = compareNameForms(el1->forms, el2->forms);
+		if (rel) return rel;  // If names are not equal return their relationship.
+	} else if (el1->forms || el2->forms) return el1->forms ? 1 : -1;
+	return compareRecordKeys(el1->element->key, el2->element->key);
 }
 
 //  keyCompare -- Compare two sequence elements by their record key fields.
@@ -226,6 +259,16 @@ static int keyCompare(SequenceEl el1, SequenceEl el2)
 	return compareRecordKeys(el1->key, el2->key);
 }
 
+//  idCompare -- Compare two sequence elements by their record ids. Elements with keys that aren't
+//    in the database come last, in key order.
+//--------------------------------------------------------------------------------------------------
+static int idCompare(SequenceEl el1, SequenceEl el2)
+{
+	if (el1->id != el2->id) return el1->id < el2->id ? -1 : 1;
+	if (el1->id != NORECORDID) return 0;
+	return compareRecordKeys(el1->key, el2->key);
+}
+
 //  valueCompare -- Compare two elements of a sequence by their values. TODO: This must be
 //    converted to using a PValue like object for the value that has a type to consult.
 //--------------------------------------------------------------------------------------------------
@@ -236,21 +279,42 @@ static int valueCompare (SequenceEl el1, SequenceEl el2)
 	return (int) (long) el1->value - (int) (long) el2->value;
 }
 
-//  nameSortSequence -- Sort a sequence by the name fields of the elements.
+//  nameSortSequence -- Sort a sequence by the name fields of the elements. Each name is parsed
+//    once, before the sort; the forms the database keeps are used for the first NAME lines of
+//    persons.
 //    TODO: WHAT IS THE NAME FIELDS HAVEN'T BEEN COMPUTED YET?
 //--------------------------------------------------------------------------------------------------
 void nameSortSequence(Sequence *seq)
 //  seq -- The sequence to be name sorted.
 {
 	// The sequence may be sorted.
-	if (seq->max & NAMESORT) return;
+	if (seq->flags & NAMESORT) return;
+
+	// Find the forms of the names.
+	int n = seq->size;
+	NameSortEl *sortEls = (NameSortEl*) stdalloc((n + 1)*sizeof(NameSortEl));
+	NameSortEl **data = (NameSortEl**) stdalloc((n + 1)*sizeof(NameSortEl*));
+	for (int i = 0; i < n; i++) {
+		SequenceEl el = IData(seq)[i];
+		NameForms *forms = null;
+		if (el->name && seq->database && el->id != NORECORDID)
+			forms = recordIdToNameForms(el->id, seq->database);
+		bool owned = el->name && !(forms && eqstr(forms->source, el->name));
+		if (owned) forms = createNameForms(el->name);
+		sortEls[i] = (NameSortEl) {el, forms, owned};
+		data[i] = sortEls + i;
+	}
 
 	// Perform the sort and set the flags.
-	sequenceSort((Word*)IData(seq), seq->size, (int(*)(Word, Word))nameCompare);
-	quickSort(0, seq->size - 1);
-	seq->max &= ~KEYSORT;
-	seq->max &= ~VALUESORT;
-	seq->max |= NAMESORT;
+	sequenceSort((Word*) data, n, (int(*)(Word, Word))nameCompare);
+	for (int i = 0; i < n; i++) {
+		IData(seq)[i] = data[i]->element;
+		if (data[i]->owned) deleteNameForms(data[i]->forms);
+	}
+	stdfree(data);
+	stdfree(sortEls);
+	seq->flags &= ~(KEYSORT|VALUESORT|IDSORT);
+	seq->flags |= NAMESORT;
 }
 
 //  keySortSequence -- Sort a sequence by key.
@@ -258,12 +322,10 @@ void nameSortSequence(Sequence *seq)
 void keySortSequence(Sequence *seq)
 //  seq -- Sequence to be sorted.
 {
-	if (seq->max & KEYSORT) return;
+	if (seq->flags & KEYSORT) return;
 	sequenceSort((Word*)IData(seq), seq->size, (int(*)(Word, Word))keyCompare);
-	quickSort(0, seq->size - 1);
-	seq->max &= ~NAMESORT;
-	seq->max &= ~VALUESORT;
-	seq->max |= KEYSORT;
+	seq->flags &= ~(NAMESORT|VALUESORT|IDSORT);
+	seq->flags |= KEYSORT;
 }
 
 //  valueSortSequence -- Sort a sequence by value.
@@ -271,24 +333,36 @@ void keySortSequence(Sequence *seq)
 void valueSortSequence(Sequence *sequence)
 //  seq -- Sequence to be sorted.
 {
-	if (sequence->max & VALUESORT) return;
+	if (sequence->flags & VALUESORT) return;
 	sequenceSort((Word*)IData(sequence), sequence->size, (int(*)(Word, Word))valueCompare);
-	quickSort(0, sequence->size - 1);
-	sequence->max &= ~NAMESORT;
-	sequence->max &= ~KEYSORT;
-	sequence->max |= VALUESORT;
+	sequence->flags &= ~(NAMESORT|KEYSORT|IDSORT);
+	sequence->flags |= VALUESORT;
+}
+
+//  idSortSequence -- Sort a sequence by record id. The set operations use this order because
+//    comparing ids is cheaper than comparing keys.
+//--------------------------------------------------------------------------------------------------
+static void idSortSequence(Sequence *sequence)
+{
+	if (sequence->flags & IDSORT) return;
+	sequenceSort((Word*)IData(sequence), sequence->size, (int(*)(Word, Word))idCompare);
+	sequence->flags &= ~(NAMESORT|KEYSORT|VALUESORT);
+	sequence->flags |= IDSORT;
 }
 
+//  sequenceSort -- Sort the elements of a sequence with a compare function.
+//--------------------------------------------------------------------------------------------------
 static void sequenceSort(Word* data, int length, int(*compare)(Word, Word))
 {
-	extern Word* ldata;
-	extern int (*lcmp)(Word, Word);
+	if (length < 2) return;
 	ldata = data;
 	lcmp = compare;
+	quickSort(0, length - 1);
 }
 
 //  uniqueSequence -- Create and return a new sequence that contains only the unique elements from
-//    the given sequence.
+//    the given sequence. The elements are compared by record id, and the new sequence is in id
+//    order.
 //--------------------------------------------------------------------------------------------------
 Sequence *uniqueSequence(Sequence *sequence)
 //  sequence -- The sequence to be uniqued.
@@ -296,25 +370,23 @@ Sequence *uniqueSequence(Sequence *sequence)
 	ASSERT(sequence);
 	Sequence *unique = createSequence(sequence->database);
 	int n = sequence->size;
-	if (n == 0 || (sequence->flags & UNIQUED)) return unique;  // Return if no action needed.
-	if (!(sequence->flags & KEYSORT)) keySortSequence(sequence);
+	if (n == 0) return unique;  // Return if no action needed.
+	idSortSequence(sequence);
 	SequenceEl *d = IData(sequence);
-	appendToSequence(unique, strsave(d[0]->key), null, null);
-	int i, j;
-	for (j = 0, i = 1; i < n; i++) {
-		if (nestr(d[i]->key, d[j]->key)) {
-			appendToSequence(unique, strsave(d[i]->key), null, null);
+	appendElement(unique, d[0]);
+	for (int j = 0, i = 1; i < n; i++) {
+		if (idCompare(d[i], d[j])) {
+			appendElement(unique, d[i]);
 			j = i;
 		}
 	}
-	unique->flags |= UNIQUED;
+	unique->flags = IDSORT|UNIQUED;
 	return unique;
 }
 
 //  uniqueSequenceInPlace -- Remove duplicates (have the same key) elements from a sequence.
-//    No new sequence is created.
-//
-//  MNOTE: This has a MEMORY LEAK -- the elements removed are not managed properly.
+//    No new sequence is created. The sequence is left in id order. The elements removed are
+//    freed with their keys and names.
 //--------------------------------------------------------------------------------------------------
 void uniqueSequenceInPlace(Sequence *sequence)
 //  sequence -- The sequence to be uniqued in place.
@@ -322,16 +394,33 @@ void uniqueSequenceInPlace(Sequence *sequence)
 	int i, j;
 	if (!sequence) return;
 	int n = sequence->size;
-	SequenceEl *d = IData(sequence);
 	if (n == 0 || (sequence->flags & UNIQUED)) return;
-	if (!(sequence->flags & KEYSORT)) keySortSequence(sequence);
-	for (j = 0, i = 1; i < n; i++)
-		if (nestr(d[i]->key, d[j]->key)) d[++j] = d[i];
+	idSortSequence(sequence);
+	SequenceEl *d = IData(sequence);
+	for (j = 0, i = 1; i < n; i++) {
+		if (idCompare(d[i], d[j])) {
+			d[++j] = d[i];
+			continue;
+		}
+		stdfree(d[i]->key);
+		if (d[i]->name) stdfree(d[i]->name);
+		stdfree(d[i]);
+	}
 	sequence->size = j + 1;
 	sequence->flags |= UNIQUED;
 }
 
-//  unionSequence -- Create the union of two sequences.
+//  prepareForSetOperation -- Sort a sequence by record id and remove its duplicates, the form the
+//    set operations need.
+//--------------------------------------------------------------------------------------------------
+static void prepareForSetOperation(Sequence *sequence)
+{
+	idSortSequence(sequence);
+	uniqueSequenceInPlace(sequence);
+}
+
+//  unionSequence -- Create the union of two sequences. The elements are merged in record id order,
+//    so most comparisons are of integers rather than keys.
 //--------------------------------------------------------------------------------------------------
 Sequence *unionSequence(Sequence *one, Sequence *two)
 //  one, two -- The two sequences to be unioned.
@@ -340,11 +429,9 @@ Sequence *unionSequence(Sequence *one, Sequence *two)
 	ASSERT(one->database == two->database);
 	if (!one || !two) return null;
 
-	// Make sure the sequences are sorted by key and uniqued.
-	if (!(one->flags & KEYSORT)) keySortSequence(one);
-	if (!(one->flags & UNIQUED)) uniqueSequenceInPlace(one);
-	if (!(two->flags & KEYSORT)) keySortSequence(two);
-	if (!(two->flags & UNIQUED)) uniqueSequenceInPlace(two);
+	// Make sure the sequences are sorted by id and uniqued.
+	prepareForSetOperation(one);
+	prepareForSetOperation(two);
 
 	int n = lengthSequence(one);
 	int m = lengthSequence(two);
@@ -353,26 +440,26 @@ Sequence *unionSequence(Sequence *one, Sequence *two)
 	SequenceEl* v = IData(two);
 	int i = 0, j = 0, rel;
 	while (i < n && j < m) {
-		if ((rel = compareRecordKeys(u[i]->key, v[j]->key)) < 0) {
-			appendToSequence(three, (u[i])->key, null, u[i]->value);
+		if ((rel = idCompare(u[i], v[j])) < 0) {
+			appendElement(three, u[i]);
 			i++;
 		} else if (rel > 0) {
-			appendToSequence(three, (v[j])->key, null, v[j]->value);
+			appendElement(three, v[j]);
 			j++;
 		} else {
-			appendToSequence(three, (u[i])->key, null, u[i]->value);
+			appendElement(three, u[i]);
 			i++; j++;
 		}
 	}
 	while (i < n) {
-		appendToSequence(three, (u[i])->key, null, u[i]->value);
+		appendElement(three, u[i]);
 		i++;
 	}
 	while (j < m) {
-		appendToSequence(three, (v[j])->key, null, v[j]->value);
+		appendElement(three, v[j]);
 		j++;
 	}
-	three->flags = KEYSORT|UNIQUED;
+	three->flags = IDSORT|UNIQUED;
 	return three;
 }
 
@@ -386,11 +473,9 @@ Sequence *intersectSequence(Sequence *one, Sequence *two)
 	if (!one || !two) return null;  // Nothing to do.
 	int rel;
 
-	// Make sure the two sequences are sorted by key and have unique elements.
-	if (!(one->flags & KEYSORT)) keySortSequence(one);
-	if (!(one->flags & UNIQUED)) uniqueSequenceInPlace(one);
-	if (!(two->flags & KEYSORT)) keySortSequence(two);
-	if (!(two->flags & UNIQUED)) uniqueSequenceInPlace(two);
+	// Make sure the two sequences are sorted by id and have unique elements.
+	prepareForSetOperation(one);
+	prepareForSetOperation(two);
 
 	// Prepare to create the intersection.
 	int n = lengthSequence(one);
@@ -400,19 +485,18 @@ Sequence *intersectSequence(Sequence *one, Sequence *two)
 	SequenceEl* u = IData(one);
 	SequenceEl* v = IData(two);
 
-	// Iteration that does the intersection. Using the integer keys not the string keys.
+	// Iteration that does the intersection. Using the record ids not the string keys.
 	while (i < n && j < m) {
-		if ((rel = compareRecordKeys(u[i]->key, v[j]->key)) < 0) {
+		if ((rel = idCompare(u[i], v[j])) < 0) {
 			i++;
 		} else if (rel > 0) {
 			j++;
 		} else {
-			//key = strsave((u[i])->seKey);
-			appendToSequence(three, (u[i])->key, null, u[i]->value);
+			appendElement(three, u[i]);
 			i++; j++;
 		}
 	}
-	three->flags = KEYSORT|UNIQUED;
+	three->flags = IDSORT|UNIQUED;
 	return three;
 }
 
@@ -425,11 +509,9 @@ Sequence *differenceSequence (Sequence *one, Sequence *two)
 	ASSERT(one->database == two->database);
 	if (!one || !two) return null;
 
-	// Make sure the two sequences are sorted by key and have unique elements.
-	if (!(one->flags & KEYSORT)) keySortSequence(one);
-	if (!(one->flags & UNIQUED)) uniqueSequenceInPlace(one);
-	if (!(two->flags & KEYSORT)) keySortSequence(two);
-	if (!(two->flags & UNIQUED)) uniqueSequenceInPlace(two);
+	// Make sure the two sequences are sorted by id and have unique elements.
+	prepareForSetOperation(one);
+	prepareForSetOperation(two);
 	int n = lengthSequence(one);
 	int m = lengthSequence(two);
 	Sequence *three = createSequence(one->database);
@@ -439,8 +521,8 @@ Sequence *differenceSequence (Sequence *one, Sequence *two)
 	int rel;
 
 	while (i < n && j < m) {
-		if ((rel = compareRecordKeys(u[i]->key, v[j]->key)) < 0) {
-			appendToSequence(three, (u[i])->key, null, u[i]->value);
+		if ((rel = idCompare(u[i], v[j])) < 0) {
+			appendElement(three, u[i]);
 			i++;
 		} else if (rel > 0) {
 			j++;
@@ -449,10 +531,10 @@ Sequence *differenceSequence (Sequence *one, Sequence *two)
 		}
 	}
 	while (i < n) {
-		appendToSequence(three, (u[i])->key, null, u[i]->value);
+		appendElement(three, u[i]);
 		i++;
 	}
-	three->flags = KEYSORT|UNIQUED;
+	three->flags = IDSORT|UNIQUED;
 	return three;
 }
 
@@ -930,9 +1012,27 @@ static void writeLimitedFamily (GNode *family)
 	printf("writeLimitedFamily: %s\n", family->key);
 }
 
+//  idsToSequence -- Create a sequence of the persons with record ids. The elements get their
+//    keys, names and ids from the database without searching its indexes.
+//--------------------------------------------------------------------------------------------------
+static Sequence *idsToSequence(RecordId *ids, int count, Database *database)
+{
+	Sequence *seq = createSequence(database);
+	for (int i = 0; i < count; i++) {
+		GNode *name = NAME(recordIdToRecord(ids[i], database));
+		SequenceEl el = (SequenceEl) stdalloc(sizeof(*el));
+		el->key = strsave(recordIdToKey(ids[i], database));
+		el->name = name && name->value ? strsave(name->value) : null;
+		el->value = null;
+		el->id = ids[i];
+		addElement(seq, el);
+	}
+	return seq;
+}
+
 //  nameToSequence -- Return the sequence of persons who match a name. The name must be formatted
 //    as a Gedcom name. However, if the first letter of the given names is a '*', the given
-//    name is treated as a wild card, and the sequencce will contain all persons that match the
+//    name is treated as a wild card, and the sequence will contain all persons with the
 //    surname.
 //--------------------------------------------------------------------------------------------------
 Sequence *nameToSequence(String name, Database *database)
@@ -957,7 +1057,7 @@ Sequence *nameToSequence(String name, Database *database)
 
 	// Wild card case -- the name starts with a '*', which matches all firstnames.
 	char scratch[MAXLINELEN+1];
-	sprintf(scratch, "a/%s/", getSurname(name));
+	snprintf(scratch, sizeof(scratch), "a/%s/", getSurname(name));
 	for (int c = 'a'; c <= 'z'; c++) {
 		scratch[0] = c;
 		String *keys = personKeysFromName(scratch, database, &num/*, true*/);
@@ -976,12 +1076,27 @@ Sequence *nameToSequence(String name, Database *database)
 		}
 	}
 	if (seq) {
-		uniqueSequence(seq);
+		uniqueSequenceInPlace(seq);
 		nameSortSequence(seq);
 	}
 	return seq;
 }
 
+//  surnamePrefixToSequence -- Return the sequence of persons with a surname that starts with a
+//    prefix. The case of the prefix's letters does not matter. The sequence is in record id
+//    order without duplicates.
+//--------------------------------------------------------------------------------------------------
+Sequence *surnamePrefixToSequence(String prefix, Database *database)
+{
+	if (!prefix || !database) return null;
+	int num;
+	RecordId *ids = personsWithSurnamePrefix(database->surnameIndex, prefix, &num);
+	Sequence *seq = idsToSequence(ids, num, database);
+	if (ids) stdfree(ids);
+	seq->flags = IDSORT|UNIQUED;
+	return seq;
+}
+
 //  format_indiseq -- Format print lines of sequence.
 //--------------------------------------------------------------------------------------------------
 //static void format_indiseq (Sequence *seq, bool famp, bool marr)
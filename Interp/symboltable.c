@@ -4,7 +4,7 @@
 //  symboltable.c -- Functions that implement the symbol table data structure.
 //
 //  Created by Thomas Wetmore on 23 March 2023.
-//  Last changed on 13 May 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "standard.h"
@@ -115,13 +115,9 @@ void showSymbolTable(SymbolTable* table)
 {
 	ASSERT(table);
 	printf("Symbol Table at Location %p\n", table);
-	for (int i = 0; i < MAX_HASH; i++) {
-		Bucket *bucket = table->buckets[i];
-		if (!bucket || bucket->length <= 0) continue;
-		for (int j = 0; j < bucket->length; j++) {
-			Symbol *symbol = (Symbol*) bucket->elements[j];
-			String pvalue = pvalueToString(*(symbol->value), false);
-			printf("  %s = %s\n", symbol->ident, pvalue);
-		}
-	}
+	FORHASHTABLE(table, element)
+		Symbol *symbol = (Symbol*) element;
+		String pvalue = pvalueToString(*(symbol->value), false);
+		printf("  %s = %s\n", symbol->ident, pvalue);
+	ENDHASHTABLE
 }
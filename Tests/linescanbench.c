@@ -0,0 +1,185 @@
+//  linescanbench.c -- Microbenchmark of the Gedcom line scanner. Splits every line of a Gedcom
+//    file into its fields, once with the byte at a time code bufferToLine used before the scanner,
+//    and once with scanNextLine, the way memoryToLine reads mapped files. Checks that both find
+//    the same fields, then shows the best time of several passes for each. Build linescan.c with
+//    -DLINESCANSIMD (and -mavx2) to time the block scanners.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+
+#include <stdio.h>
+#include "standard.h"
+#include "utils.h"
+#include "linescan.h"
+
+#define NUMPASSES 10
+
+//  Fields -- The fields of one line; both scanners fill these in.
+//--------------------------------------------------------------------------------------------------
+typedef struct Fields {
+	int level;
+	String key;
+	String tag;
+	String value;
+} Fields;
+
+//  oldBufferToLine -- The field extraction bufferToLine did before it used the scanner.
+//--------------------------------------------------------------------------------------------------
+static bool oldBufferToLine(String p, Fields *fields)
+{
+	fields->key = fields->value = null;
+	striptrail(p);
+	if (strlen(p) > MAXLINELEN) return false;
+	while (iswhite(*p)) p++;
+	if (chartype(*p) != DIGIT) return false;
+	int level = *p++ - '0';
+	while (chartype(*p) == DIGIT) level = level*10 + *p++ - '0';
+	fields->level = level;
+	while (iswhite(*p)) p++;
+	if (*p == 0) return false;
+	if (*p == '@') {
+		fields->key = p++;
+		if (*p == '@') return false;
+		while (*p != '@' && *p != 0) p++;
+		if (*p == 0) return false;
+		if (*++p != ' ') return false;
+		*p++ = 0;
+	}
+	while (iswhite(*p)) p++;
+	if (*p == 0) return false;
+	fields->tag = p++;
+	while (!iswhite(*p) && *p != 0) p++;
+	if (*p == 0) return true;
+	*p++ = 0;
+	while (iswhite(*p)) p++;
+	fields->value = p;
+	return true;
+}
+
+//  spansToFields -- Terminate the fields found by the scanner the way bufferToLine does.
+//--------------------------------------------------------------------------------------------------
+static void spansToFields(String p, LineSpans *spans, Fields *fields)
+{
+	fields->level = spans->level;
+	p[spans->end] = 0;
+	if (spans->key.start >= 0) {
+		fields->key = p + spans->key.start;
+		p[spans->key.start + spans->key.length] = 0;
+	}
+	fields->tag = p + spans->tag.start;
+	p[spans->tag.start + spans->tag.length] = 0;
+	if (spans->value.start >= 0) fields->value = p + spans->value.start;
+}
+
+//  oldPass -- Split the lines of a buffer the old way. If fields is not null the fields of each
+//    line are saved in it. Returns the number of lines.
+//--------------------------------------------------------------------------------------------------
+static int oldPass(String p, String end, Fields *fields)
+{
+	int count = 0;
+	Fields scratch;
+	while (p < end) {
+		String line = p;
+		String newline = memchr(p, '\n', end - p);
+		if (newline) *newline = 0;
+		p = newline ? newline + 1 : end;
+		if (allwhite(line)) continue;
+		Fields *f = fields ? fields + count : &scratch;
+		if (!oldBufferToLine(line, f)) f->tag = null;
+		count++;
+	}
+	return count;
+}
+
+//  newPass -- Split the lines of a buffer with the scanner.
+//--------------------------------------------------------------------------------------------------
+static int newPass(String p, String end, Fields *fields)
+{
+	int count = 0;
+	Fields scratch;
+	LineSpans spans;
+	while (p < end) {
+		String line = p;
+		LineScanCode code = scanNextLine(line, end, &spans, &p);
+		if (code == ScanBlank) continue;
+		Fields *f = fields ? fields + count : &scratch;
+		f->key = f->value = f->tag = null;
+		if (code == ScanOkay) spansToFields(line, &spans, f);
+		count++;
+	}
+	return count;
+}
+
+//  sameString -- Check whether two fields are the same.
+//--------------------------------------------------------------------------------------------------
+static bool sameString(String a, String b)
+{
+	if (!a || !b) return a == b;
+	return eqstr(a, b);
+}
+
+//  bestTime -- Return the best time of NUMPASSES passes over fresh copies of the file.
+//--------------------------------------------------------------------------------------------------
+static double bestTime(String source, String work, size_t size, int (*pass)(String, String, Fields*))
+{
+	double best = 1e9;
+	for (int i = 0; i < NUMPASSES; i++) {
+		memcpy(work, source, size + 1);
+		double start = getseconds();
+		pass(work, work + size, null);
+		double time = getseconds() - start;
+		if (time < best) best = time;
+	}
+	return best;
+}
+
+int main(int argc, char **argv)
+{
+	String fileName = argc > 1 ? argv[1] : "../Gedfiles/main.ged";
+	FILE *file = fopen(fileName, "r");
+	if (!file) {
+		printf("Could not open %s\n", fileName);
+		return 1;
+	}
+	fseek(file, 0, SEEK_END);
+	size_t size = ftell(file);
+	rewind(file);
+	String source = stdalloc(size + 1);
+	String oldWork = stdalloc(size + 1);
+	String newWork = stdalloc(size + 1);
+	if (fread(source, 1, size, file) != size) {
+		printf("Could not read %s\n", fileName);
+		return 1;
+	}
+	source[size] = 0;
+	fclose(file);
+
+	//  Check that both ways find the same fields on every line.
+	memcpy(oldWork, source, size + 1);
+	memcpy(newWork, source, size + 1);
+	int maxLines = 1;
+	for (size_t i = 0; i < size; i++) if (source[i] == '\n') maxLines++;
+	Fields *oldFields = (Fields*) stdalloc(maxLines*sizeof(Fields));
+	Fields *newFields = (Fields*) stdalloc(maxLines*sizeof(Fields));
+	int numLines = oldPass(oldWork, oldWork + size, oldFields);
+	int numNew = newPass(newWork, newWork + size, newFields);
+	int differences = numLines == numNew ? 0 : 1;
+	for (int i = 0; i < numLines && i < numNew; i++) {
+		Fields *a = oldFields + i, *b = newFields + i;
+		if (!sameString(a->tag, b->tag) || (a->tag && (a->level != b->level ||
+			!sameString(a->key, b->key) || !sameString(a->value, b->value)))) {
+			if (differences++ < 10) printf("Line %d differs\n", i + 1);
+		}
+	}
+	printf("%s: %d lines, %ld bytes; %d differences.\n", fileName, numLines, (long) size, differences);
+
+	//  Time both ways.
+	double oldTime = bestTime(source, oldWork, size, oldPass);
+	double newTime = bestTime(source, newWork, size, newPass);
+	printf("byte at a time: %8.3f ms  %6.1f ns/line  %7.1f MB/s\n", 1000*oldTime,
+		   1e9*oldTime/numLines, size/oldTime/1e6);
+	printf("%-14s: %8.3f ms  %6.1f ns/line  %7.1f MB/s\n", lineScannerName(), 1000*newTime,
+		   1e9*newTime/numLines, size/newTime/1e6);
+	printf("speedup: %.2f\n", oldTime/newTime);
+	return differences != 0;
+}
@@ -1,16 +1,69 @@
 //  testhashtable.c -- Test the hastable data type.
 //
 //  Created by Thomas Wetmore on 25 September 2023.
-//  Last changed on 26 September 2023.
+//  Last changed on 17 October 2026.
 
 #include "hashtable.h"
 
+#define NUMKEYS 100000
+
 String getKey(Word key) {
     return (String) key;
 }
 
+static int errors = 0;
+
+//  check -- Report a test that failed.
+static void check(bool okay, String message)
+{
+    if (okay) return;
+    printf("FAILED: %s\n", message);
+    errors++;
+}
+
 int main(void)
 {
     HashTable *table = createHashTable(NULL, NULL, getKey);
     showHashTable(table, NULL);
+    check(!searchHashTable(table, "@I1@"), "search of empty table");
+
+    //  Insert enough keys to make the table grow many times.
+    String *keys = (String*) stdalloc(NUMKEYS*sizeof(String));
+    char scratch[20];
+    for (int i = 0; i < NUMKEYS; i++) {
+        sprintf(scratch, "@I%d@", i + 1);
+        keys[i] = strsave(scratch);
+        insertInHashTable(table, keys[i]);
+    }
+    check(sizeHashTable(table) == NUMKEYS, "size after inserts");
+    check(table->capacity >= NUMKEYS && 4*table->count <= 3*table->capacity, "load after growth");
+    for (int i = 0; i < NUMKEYS; i++)
+        if (searchHashTable(table, keys[i]) != keys[i]) check(false, "search for inserted key");
+    check(!isInHashTable(table, "@F1@"), "search for missing key");
+
+    //  Remove every other key, half by key and half by element.
+    for (int i = 0; i < NUMKEYS; i += 2) {
+        if (i % 4) removeElement(table, keys[i]);
+        else removeFromHashTable(table, keys[i]);
+    }
+    check(sizeHashTable(table) == NUMKEYS/2, "size after removes");
+    for (int i = 0; i < NUMKEYS; i++)
+        if (isInHashTable(table, keys[i]) != (i % 2 == 1)) check(false, "search after removes");
+
+    //  Iterate, skipping some elements with continue.
+    int count = 0, skipped = 0;
+    FORHASHTABLE(table, element)
+        if (((String) element)[2] == '7') {
+            skipped++;
+            continue;
+        }
+        count++;
+    ENDHASHTABLE
+    check(count + skipped == NUMKEYS/2, "iteration count");
+
+    deleteHashTable(table);
+    for (int i = 0; i < NUMKEYS; i++) stdfree(keys[i]);
+    stdfree(keys);
+    printf("testhashtable: %d errors\n", errors);
+    return errors != 0;
 }
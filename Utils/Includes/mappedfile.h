@@ -0,0 +1,29 @@
+//
+//  DeadEnds
+//
+//  mappedfile.h -- Header file for files that are memory mapped for reading.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#ifndef mappedfile_h
+#define mappedfile_h
+
+#include "standard.h"
+
+//  MappedFile -- A file whose contents are mapped into memory. The contents are always followed
+//    by a 0 byte, so the contents can be treated as one long String. The mapping is private, so
+//    the contents can be changed in memory without changing the file.
+//--------------------------------------------------------------------------------------------------
+typedef struct MappedFile {
+	String fileName;  // Name of the mapped file.
+	String data;      // Contents of the file followed by a 0 byte.
+	size_t size;      // Number of bytes in the file, not counting the 0 byte.
+	bool isMapped;    // True if data is a mapping; false if it is a copy in the heap.
+} MappedFile;
+
+MappedFile *createMappedFile(String fileName);  // Map a file into memory.
+void deleteMappedFile(MappedFile*);  // Unmap a file and free its structure.
+
+#endif // mappedfile_h
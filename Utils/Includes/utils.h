@@ -3,7 +3,7 @@
 //  ImportGedcom
 //
 //  Created by Thomas Wetmore on 13 November 2022.
-//  Last changed on 13 November 2022.
+//  Last changed on 17 October 2026.
 //
 
 #ifndef utils_h
@@ -12,5 +12,6 @@
 #include <stdio.h>
 
 double getmilliseconds(void);
+double getseconds(void);
 
 #endif /* utils_h */
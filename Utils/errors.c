@@ -4,7 +4,7 @@
 //  errors.c -- Code for handling DeadEnds errors.
 //
 //  Created by Thomas Wetmore on 4 July 2023.
-//  Last changed on 22 November 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include "errors.h"
@@ -62,6 +62,13 @@ ErrorLog *createErrorLog(void)
 	return errorLog;
 }
 
+//  deleteErrorLog -- Delete an error log and the errors in it.
+//--------------------------------------------------------------------------------------------------
+void deleteErrorLog(ErrorLog *errorLog)
+{
+	deleteList(errorLog);
+}
+
 //  createError -- Create an Error.
 //--------------------------------------------------------------------------------------------------
 Error *createError(ErrorType type, String fileName, int lineNumber, String message)
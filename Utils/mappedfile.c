@@ -0,0 +1,90 @@
+//
+//  DeadEnds
+//
+//  mappedfile.c -- Functions that map files into memory so they can be read without copying.
+//    Gedcom files are read this way so the node trees built from them can point into the
+//    mapping instead of holding their own copies of keys and values.
+//
+//  Created by Thomas Wetmore on 17 October 2026.
+//  Last changed on 17 October 2026.
+//
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include "standard.h"
+#include "mappedfile.h"
+
+//  readWholeFile -- Read the contents of a file into the heap, followed by a 0 byte. Used when
+//    a file cannot be mapped, or when its size is a multiple of the page size so the mapping
+//    would leave no room for the 0 byte.
+//--------------------------------------------------------------------------------------------------
+static String readWholeFile(int fd, size_t size)
+{
+	String data = stdalloc(size + 1);
+	size_t done = 0;
+	while (done < size) {
+		ssize_t n = read(fd, data + done, size - done);
+		if (n <= 0) {
+			stdfree(data);
+			return null;
+		}
+		done += n;
+	}
+	data[size] = 0;
+	return data;
+}
+
+//  createMappedFile -- Map a file into memory. The mapping is private and writable; changes
+//    made to the contents, such as replacing newlines with 0s, are not written back to the file.
+//    Returns null if the file cannot be opened or read.
+//--------------------------------------------------------------------------------------------------
+MappedFile *createMappedFile(String fileName)
+//  fileName -- Name of the file to map.
+{
+	ASSERT(fileName);
+	int fd = open(fileName, O_RDONLY);
+	if (fd < 0) return null;
+	struct stat info;
+	if (fstat(fd, &info) < 0) {
+		close(fd);
+		return null;
+	}
+	size_t size = (size_t) info.st_size;
+	String data = null;
+	bool isMapped = false;
+
+	//  The bytes past the end of the file up to the end of its last page are 0 in the mapping, so
+	//    the contents are terminated unless the file fills its last page exactly.
+	long pageSize = sysconf(_SC_PAGESIZE);
+	if (size > 0 && size % pageSize != 0) {
+		data = mmap(null, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) data = null;
+		else {
+			isMapped = true;
+			madvise(data, size, MADV_SEQUENTIAL);
+		}
+	}
+	if (!data) data = readWholeFile(fd, size);
+	close(fd);
+	if (!data) return null;
+
+	MappedFile *mappedFile = (MappedFile*) stdalloc(sizeof(MappedFile));
+	mappedFile->fileName = strsave(fileName);
+	mappedFile->data = data;
+	mappedFile->size = size;
+	mappedFile->isMapped = isMapped;
+	return mappedFile;
+}
+
+//  deleteMappedFile -- Unmap a file and free its structure. Any nodes that point into the
+//    mapping must not be used afterwards.
+//--------------------------------------------------------------------------------------------------
+void deleteMappedFile(MappedFile *mappedFile)
+{
+	ASSERT(mappedFile);
+	if (mappedFile->isMapped) munmap(mappedFile->data, mappedFile->size);
+	else stdfree(mappedFile->data);
+	stdfree(mappedFile->fileName);
+	stdfree(mappedFile);
+}
@@ -4,7 +4,7 @@
 //  path.c - Functions to manipulate UNIX file paths
 //
 //  Created by Thomas Wetmore on 14 December 2022.
-//  Last changed on 20 January 2023.
+//  Last changed on 17 October 2026.
 //
 
 #include <unistd.h>  // access.
@@ -82,12 +82,13 @@ FILE *fopenPath (String name, String mode, String path)
 	return fopen(str, mode);
 }
 
-// lastPathSegment -- Return the last componenet of a path.
+// lastPathSegment -- Return the last componenet of a path. MNOTE: The segment is in a buffer that
+//    belongs to the calling thread; it is overwritten by the thread's next call.
 //--------------------------------------------------------------------------------------------------
 String lastPathSegment (String path)
 //  path -- Path to find the last component of.
 {
-	static unsigned char scratch[MAXPATHBUFFER];
+	static _Thread_local unsigned char scratch[MAXPATHBUFFER];
 	if (!path || *path == 0) return NULL;
 	int len = (int) strlen(path);
 	String p = (String) scratch, q;
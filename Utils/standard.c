@@ -4,7 +4,7 @@
 //  standard.c -- Standard routines.
 //
 //  Create by Thomas Wetmore on 7 November 2022.
-//  Last changed on 22 November 2023.
+//  Last changed on 17 October 2026.
 
 #include <stdlib.h>
 #include "standard.h"
@@ -241,7 +241,7 @@ String trim(String string, int maxLength)
 // String string -- String that may have to be trimmed.
 // int maxLength -- Maximum desired length of string.
 {
-	static char scratch[MAXLINELEN+1];
+	static _Thread_local char scratch[MAXLINELEN+1];
 	if (!string || strlen(string) > MAXLINELEN) return null;
 	if (maxLength < 0) maxLength = 0;
 	if (maxLength > MAXLINELEN) maxLength = MAXLINELEN;
@@ -4,10 +4,11 @@
 //  utils.c
 //
 //  Created by Thomas Wetmore on 13 November 2022.
-//  Last changed on 6 November 2022.
+//  Last changed on 17 October 2026.
 //
 
 #include <sys/time.h>
+#include <time.h>
 #include "utils.h"
 
 // Get current time in milliseconds modulo 10 seconds.
@@ -20,3 +21,11 @@ double getmilliseconds(void) {
     int milliseconds = (int) (time.tv_usec/1000);
     return seconds + milliseconds / 1000.;
 }
+
+// getseconds -- Get the time in seconds from a monotonic clock; use differences to time things.
+//--------------------------------------------------------------------------------------------------
+double getseconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}